@@ -0,0 +1,245 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+
+#include "game_board.h"
+#include "game_node.h"
+#include "game_tree.h"
+#include "monte_carlo_tree.h"
+#include "player.h"
+#include "proof_number_solver.h"
+
+// Every allocation of the process is counted, so each measure reports the allocations of its operation.
+static atomic<uint64_t> allocationCount { 0 };
+
+void * operator new(size_t size)
+{
+    allocationCount.fetch_add(1, memory_order_relaxed);
+
+    if (void * memory = malloc(size == 0 ? 1 : size)) return memory;
+
+    throw bad_alloc {};
+}
+
+void operator delete(void * memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void * memory, size_t) noexcept
+{
+    free(memory);
+}
+
+// Each operation runs for at least this long, in batches that double in size.
+static constexpr chrono::milliseconds MIN_BENCH_TIME { 200 };
+
+// Limits of the proof-number solves timed, so each fixture stays within a few seconds.
+static constexpr uint64_t BENCH_PROOF_NODE_LIMIT = 20000;
+static constexpr size_t BENCH_PROOF_MEMORY_LIMIT = size_t { 4 } << 20;
+
+// Playouts of each Monte Carlo search timed; nodes_per_op reports the playouts.
+static constexpr uint64_t BENCH_PLAYOUT_BUDGET = 2000;
+
+// Entries of the transposition table of each search timed; each one gets a fresh table, so clearing it
+// has to stay small next to the search itself.
+static constexpr size_t BENCH_TRANSPOSITION_TABLE_SIZE = size_t { 1 } << 14;
+
+// A board to run the operations on, built from its plays, X first: "H8 I9 ...".
+struct Fixture
+{
+    string name;
+    GameBoard gameBoard;
+    PlayerMarker playerToMove;
+};
+
+struct Measure
+{
+    uint64_t operationCount = 0;
+    double seconds = 0;
+    uint64_t allocationCount = 0;
+    uint64_t nodeCount = 0;
+};
+
+// Keeps the results of the operations, so the compiler can not optimize them away.
+static volatile int sink = 0;
+
+static GameBoard boardOf(const string & plays)
+{
+    GameBoard gameBoard;
+    PlayerMarker marker = X;
+
+    istringstream input { plays };
+    string play;
+
+    while (input >> play)
+    {
+        gameBoard = gameBoard.play(GamePosition { stoi(play.substr(1)) - 1, play[0] - 'A' }, marker);
+        marker = opponentOf(marker);
+    }
+
+    return gameBoard;
+}
+
+// Both players fill the board on runs of two, so neither completes a sequence; a few positions are left empty.
+static GameBoard nearFullBoard()
+{
+    GameBoard gameBoard;
+
+    for (int line = 0; line < LINE_COUNT; line++)
+    {
+        for (int column = 0; column < COLUMN_COUNT; column++)
+        {
+            if ((line * COLUMN_COUNT + column) % 11 != 0)
+            {
+                gameBoard = gameBoard.play(GamePosition { line, column }, (column + 2 * line) / 2 % 2 == 0 ? X : O);
+            }
+        }
+    }
+
+    return gameBoard;
+}
+
+static vector<Fixture> fixtures()
+{
+    return vector<Fixture>
+    {
+        { "opening", boardOf("H8 I9 G9"), O },
+        { "midgame", boardOf("J10 J12 L10 K10 L12 L11 M12 K11 J9 J11 M11 K13 K12 I11 H11 H10 G9 I9 G10 F11"), X },
+        { "tactical", boardOf("H8 H9 I8 I9 J8 G10 F9 J11 K7 L6"), X },
+        { "near-full", nearFullBoard(), X },
+    };
+}
+
+template <class Operation>
+static Measure measure(Operation operation)
+{
+    operation(); // Warms up caches and lazily built tables.
+
+    Measure result;
+
+    for (uint64_t batch = 1; result.seconds < chrono::duration<double>(MIN_BENCH_TIME).count(); batch *= 2)
+    {
+        const uint64_t allocations = allocationCount.load(memory_order_relaxed);
+        const auto start = chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < batch; i++)
+        {
+            result.nodeCount += operation();
+        }
+
+        result.seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        result.allocationCount += allocationCount.load(memory_order_relaxed) - allocations;
+        result.operationCount += batch;
+    }
+
+    return result;
+}
+
+// One line of JSON per fixture and operation.
+static void report(const string & fixture, const string & operation, const Measure & measure)
+{
+    const double operationCount = double(measure.operationCount);
+
+    cout << "{\"fixture\":\"" << fixture << "\",\"operation\":\"" << operation << '"';
+    cout << ",\"ops\":" << measure.operationCount;
+    cout << ",\"ns_per_op\":" << measure.seconds * 1e9 / operationCount;
+    cout << ",\"allocs_per_op\":" << double(measure.allocationCount) / operationCount;
+
+    if (measure.nodeCount > 0)
+    {
+        cout << ",\"nodes_per_op\":" << double(measure.nodeCount) / operationCount;
+        cout << ",\"nodes_per_second\":" << double(measure.nodeCount) / measure.seconds;
+    }
+
+    cout << "}" << endl;
+}
+
+static void bench(const Fixture & fixture)
+{
+    const GameBoard & gameBoard = fixture.gameBoard;
+    const GamePosition position = gameBoard.emptyPositions().front();
+
+    report(fixture.name, "emptyPositions", measure([&gameBoard]()
+    {
+        sink = sink + int(gameBoard.emptyPositions().size());
+        return uint64_t { 0 };
+    }));
+
+    report(fixture.name, "play", measure([&gameBoard, &position, &fixture]()
+    {
+        sink = sink + gameBoard.play(position, fixture.playerToMove).markCount();
+        return uint64_t { 0 };
+    }));
+
+    // The board keeps its winner and heuristic score as positions are played and undone, so this is what scoring a node takes.
+    SearchBoard searchBoard { gameBoard };
+
+    report(fixture.name, "makeMove+undoMove", measure([&searchBoard, &position, &fixture]()
+    {
+        searchBoard.makeMove(position, fixture.playerToMove);
+        sink = sink + searchBoard.gameBoard().heuristicScore() + searchBoard.gameBoard().hasWinner();
+        searchBoard.undoMove();
+        return uint64_t { 0 };
+    }));
+
+    report(fixture.name, "childrenFor", measure([&gameBoard, &fixture]()
+    {
+        sink = sink + int(GameNode { gameBoard }.childrenFor(fixture.playerToMove).size());
+        return uint64_t { 0 };
+    }));
+
+    report(fixture.name, "proofNumberSolve", measure([&gameBoard, &fixture]()
+    {
+        ProofNumberSolver solver { gameBoard, BENCH_PROOF_NODE_LIMIT, BENCH_PROOF_MEMORY_LIMIT };
+        vector<GamePosition> line;
+
+        sink = sink + solver.solve(fixture.playerToMove, line);
+
+        return solver.nodeCount();
+    }));
+
+    report(fixture.name, "monteCarlo", measure([&gameBoard, &fixture]()
+    {
+        MonteCarloSettings settings;
+        settings.playoutBudget = BENCH_PLAYOUT_BUDGET;
+
+        MonteCarloTree monteCarloTree { gameBoard, settings };
+
+        sink = sink + BitBoard::indexOf(monteCarloTree.bestPositionFor(fixture.playerToMove));
+
+        return monteCarloTree.playoutCount();
+    }));
+
+    for (const PlayerSkill skill : { Novice, Medium, Expert, Master })
+    {
+        report(fixture.name, "bestPositionFor:" + to_string(skill), measure([&gameBoard, &fixture, skill]()
+        {
+            GameTree gameTree { gameBoard, skill, BENCH_TRANSPOSITION_TABLE_SIZE };
+            gameTree.setQuiet(true);
+
+            sink = sink + BitBoard::indexOf(gameTree.bestPositionFor(fixture.playerToMove));
+
+            return gameTree.nodeCount();
+        }));
+    }
+}
+
+// Times the hot paths on fixed boards: gomoku_bench [fixture name]
+int main(int argc, char * argv[])
+{
+    const string only = argc > 1 ? argv[1] : "";
+
+    for (const Fixture & fixture : fixtures())
+    {
+        if (only.empty() or only == fixture.name)
+        {
+            bench(fixture);
+        }
+    }
+
+    return 0;
+}
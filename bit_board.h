@@ -0,0 +1,271 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "game_position.h"
+
+// Candidates for the next play are the empty positions this close to any mark, on lines, columns or diagonals.
+static constexpr int CANDIDATE_DISTANCE = 2;
+
+// A set of positions of a board of the given geometry, one bit per position, BIT_STRIDE bits per line.
+template <class Geometry>
+class BasicBitBoard
+{
+public:
+
+    static int indexOf(const GamePosition & position)
+    {
+        return position.line() * Geometry::BIT_STRIDE + position.column();
+    }
+
+    static GamePosition positionOf(const int index)
+    {
+        return GamePosition { index / Geometry::BIT_STRIDE, index % Geometry::BIT_STRIDE };
+    }
+
+    // Whether the position is on a board of this geometry.
+    static bool contains(const GamePosition & position)
+    {
+        return position.line() >= 0 and position.line() < Geometry::LINE_COUNT and
+               position.column() >= 0 and position.column() < Geometry::COLUMN_COUNT;
+    }
+
+    static GamePosition center()
+    {
+        return GamePosition { Geometry::LINE_COUNT / 2, Geometry::COLUMN_COUNT / 2 };
+    }
+
+    static GameArea fullArea()
+    {
+        return GameArea { 0, 0, Geometry::LINE_COUNT - 1, Geometry::COLUMN_COUNT - 1 };
+    }
+
+    static BasicBitBoard of(const GameArea & area)
+    {
+        BasicBitBoard result;
+
+        for (int line = imax(0, area.startLine()); line <= imin(area.endLine(), Geometry::LINE_COUNT - 1); line++)
+        {
+            for (int column = imax(0, area.startColumn()); column <= imin(area.endColumn(), Geometry::COLUMN_COUNT - 1); column++)
+            {
+                result.set(line * Geometry::BIT_STRIDE + column);
+            }
+        }
+
+        return result;
+    }
+
+    bool test(const int index) const
+    {
+        return (_words[index / WORD_BITS] >> (index % WORD_BITS)) & 1;
+    }
+
+    bool test(const GamePosition & position) const
+    {
+        return contains(position) and test(indexOf(position));
+    }
+
+    void set(const int index)
+    {
+        _words[index / WORD_BITS] |= uint64_t { 1 } << (index % WORD_BITS);
+    }
+
+    void reset(const int index)
+    {
+        _words[index / WORD_BITS] &= ~(uint64_t { 1 } << (index % WORD_BITS));
+    }
+
+    bool any() const
+    {
+        uint64_t bits = 0;
+
+        for (const auto & word : _words) bits |= word;
+
+        return bits != 0;
+    }
+
+    int count() const
+    {
+        int result = 0;
+
+        for (const auto & word : _words) result += __builtin_popcountll(word);
+
+        return result;
+    }
+
+    // Index of the position of the set after the first "rank" ones, in index order; -1 past the last.
+    int nth(int rank) const
+    {
+        for (int i = 0; i < Geometry::WORD_COUNT; i++)
+        {
+            uint64_t word = _words[i];
+            const int wordCount = __builtin_popcountll(word);
+
+            if (rank < wordCount)
+            {
+                for (; rank > 0; rank--) word &= word - 1;
+
+                return i * WORD_BITS + __builtin_ctzll(word);
+            }
+
+            rank -= wordCount;
+        }
+
+        return -1;
+    }
+
+    // Moves every bit "bits" positions towards index zero; bits shifted out are dropped.
+    BasicBitBoard shiftedDown(const int bits) const
+    {
+        BasicBitBoard result;
+
+        const int wordShift = bits / WORD_BITS;
+        const int bitShift = bits % WORD_BITS;
+
+        for (int i = 0; i + wordShift < Geometry::WORD_COUNT; i++)
+        {
+            result._words[i] = _words[i + wordShift] >> bitShift;
+
+            if (bitShift != 0 and i + wordShift + 1 < Geometry::WORD_COUNT)
+            {
+                result._words[i] |= _words[i + wordShift + 1] << (WORD_BITS - bitShift);
+            }
+        }
+
+        return result;
+    }
+
+    // Moves every bit "bits" positions away from index zero; bits landing off the board are dropped.
+    BasicBitBoard shiftedUp(const int bits) const
+    {
+        BasicBitBoard result;
+
+        const int wordShift = bits / WORD_BITS;
+        const int bitShift = bits % WORD_BITS;
+
+        for (int i = Geometry::WORD_COUNT - 1; i - wordShift >= 0; i--)
+        {
+            result._words[i] = _words[i - wordShift] << bitShift;
+
+            if (bitShift != 0 and i - wordShift - 1 >= 0)
+            {
+                result._words[i] |= _words[i - wordShift - 1] >> (WORD_BITS - bitShift);
+            }
+        }
+
+        return result & allSlots();
+    }
+
+    // Sets of "length" consecutive bits on the direction given by "shift", identified by their first bit.
+    BasicBitBoard runsOf(const int length, const int shift) const
+    {
+        BasicBitBoard result = *this;
+
+        for (int step = 1; step < length and result.any(); step++)
+        {
+            result = result & shiftedDown(step * shift);
+        }
+
+        return result;
+    }
+
+    template <class Function>
+    void forEach(Function function) const
+    {
+        for (int i = 0; i < Geometry::WORD_COUNT; i++)
+        {
+            uint64_t word = _words[i];
+
+            while (word != 0)
+            {
+                function(i * WORD_BITS + __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    BasicBitBoard operator & (const BasicBitBoard & other) const
+    {
+        BasicBitBoard result;
+
+        for (int i = 0; i < Geometry::WORD_COUNT; i++) result._words[i] = _words[i] & other._words[i];
+
+        return result;
+    }
+
+    BasicBitBoard operator | (const BasicBitBoard & other) const
+    {
+        BasicBitBoard result;
+
+        for (int i = 0; i < Geometry::WORD_COUNT; i++) result._words[i] = _words[i] | other._words[i];
+
+        return result;
+    }
+
+    // Complement within the board; the padding column stays clear.
+    BasicBitBoard operator ~ () const
+    {
+        BasicBitBoard result;
+
+        for (int i = 0; i < Geometry::WORD_COUNT; i++) result._words[i] = ~_words[i];
+
+        return result & allSlots();
+    }
+
+    bool operator == (const BasicBitBoard & other) const
+    {
+        for (int i = 0; i < Geometry::WORD_COUNT; i++)
+        {
+            if (_words[i] != other._words[i]) return false;
+        }
+
+        return true;
+    }
+
+    bool operator != (const BasicBitBoard & other) const
+    {
+        return not (*this == other);
+    }
+
+    // Positions at most CANDIDATE_DISTANCE lines and columns away from the given one, itself included.
+    static const BasicBitBoard & neighborhoodOf(const int index)
+    {
+        static const vector<BasicBitBoard> neighborhoods = []()
+        {
+            vector<BasicBitBoard> result { size_t(Geometry::BIT_COUNT) };
+
+            for (int line = 0; line < Geometry::LINE_COUNT; line++)
+            {
+                for (int column = 0; column < Geometry::COLUMN_COUNT; column++)
+                {
+                    result[size_t(line * Geometry::BIT_STRIDE + column)] = of(GameArea
+                    {
+                        line - CANDIDATE_DISTANCE, column - CANDIDATE_DISTANCE,
+                        line + CANDIDATE_DISTANCE, column + CANDIDATE_DISTANCE
+                    });
+                }
+            }
+
+            return result;
+        }();
+
+        return neighborhoods[size_t(index)];
+    }
+
+    static const BasicBitBoard & allSlots()
+    {
+        static const BasicBitBoard all = of(fullArea());
+
+        return all;
+    }
+
+private:
+
+    uint64_t _words[Geometry::WORD_COUNT] = {};
+
+};
+
+typedef BasicBitBoard<StandardGeometry> BitBoard;
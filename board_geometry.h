@@ -0,0 +1,87 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "score.h"
+
+// Bits of each word of a BitBoard.
+static constexpr int WORD_BITS = 64;
+
+// Dimensions of the board and the number of marks in a row that wins the game, with everything derived
+// from them; the board classes take it as a template parameter, so each geometry is compiled on its own,
+// with all its loops and masks sized at compile time.
+template <int LineCount, int ColumnCount, int WinningCount>
+struct BoardGeometry
+{
+    static_assert(WinningCount > 1 and WinningCount < LineCount and WinningCount < ColumnCount,
+                  "The winning sequence must fit on the board, with room to spare for the diagonals scanned.");
+
+    static constexpr int LINE_COUNT = LineCount;
+    static constexpr int COLUMN_COUNT = ColumnCount;
+    static constexpr int WINNING_COUNT = WinningCount;
+
+    // Each line takes BIT_STRIDE bits; the extra column is never set, so shifting a set
+    // horizontally or diagonally can not wrap a sequence from one line into the next.
+    static constexpr int BIT_STRIDE = COLUMN_COUNT + 1;
+    static constexpr int BIT_COUNT = LINE_COUNT * BIT_STRIDE;
+    static constexpr int WORD_COUNT = (BIT_COUNT + WORD_BITS - 1) / WORD_BITS;
+
+    // Shift amounts that move a bit to its neighbor on each of the four line directions.
+    static constexpr int EAST_SHIFT = 1;
+    static constexpr int SOUTH_SHIFT = BIT_STRIDE;
+    static constexpr int SOUTHEAST_SHIFT = BIT_STRIDE + 1;
+    static constexpr int SOUTHWEST_SHIFT = BIT_STRIDE - 1;
+
+    // Lines scanned by the heuristic function: every row and column, and the diagonals
+    // starting on the positions HeuristicLines lists (the same ones GameEvaluator has always scanned).
+    static constexpr int HEURISTIC_LINE_COUNT =
+        LINE_COUNT + // Horizontal
+        COLUMN_COUNT + // Vertical
+        (LINE_COUNT - WINNING_COUNT + 1) + // Diagonal - Northeast - Superior
+        (COLUMN_COUNT - WINNING_COUNT - 1) + // Diagonal - Northeast - Inferior
+        (COLUMN_COUNT - WINNING_COUNT) + // Diagonal - Southeast - Superior
+        (LINE_COUNT - WINNING_COUNT - 1); // Diagonal - Southeast - Inferior
+
+    static constexpr int MAX_LINE_LENGTH = LINE_COUNT > COLUMN_COUNT ? LINE_COUNT : COLUMN_COUNT;
+
+    static constexpr Score MAX_SCORE = maxScoreOf(WINNING_COUNT);
+    static constexpr Score MIN_SCORE = minScoreOf(WINNING_COUNT);
+};
+
+// Definitions of the members above, for the ones passed by reference, such as to imin() and imax().
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::LINE_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::COLUMN_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::WINNING_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::BIT_STRIDE;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::BIT_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::WORD_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::EAST_SHIFT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::SOUTH_SHIFT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::SOUTHEAST_SHIFT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::SOUTHWEST_SHIFT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::HEURISTIC_LINE_COUNT;
+template <int L, int C, int W> constexpr int BoardGeometry<L, C, W>::MAX_LINE_LENGTH;
+template <int L, int C, int W> constexpr Score BoardGeometry<L, C, W>::MAX_SCORE;
+template <int L, int C, int W> constexpr Score BoardGeometry<L, C, W>::MIN_SCORE;
+
+// The board the game is played on; the constants below are the ones of this geometry.
+typedef BoardGeometry<15, 15, 5> StandardGeometry;
+
+static constexpr int LINE_COUNT = StandardGeometry::LINE_COUNT;
+static constexpr int COLUMN_COUNT = StandardGeometry::COLUMN_COUNT;
+static constexpr int WINNING_COUNT = StandardGeometry::WINNING_COUNT;
+
+static constexpr int BIT_STRIDE = StandardGeometry::BIT_STRIDE;
+static constexpr int BIT_COUNT = StandardGeometry::BIT_COUNT;
+static constexpr int WORD_COUNT = StandardGeometry::WORD_COUNT;
+
+static constexpr int EAST_SHIFT = StandardGeometry::EAST_SHIFT;
+static constexpr int SOUTH_SHIFT = StandardGeometry::SOUTH_SHIFT;
+static constexpr int SOUTHEAST_SHIFT = StandardGeometry::SOUTHEAST_SHIFT;
+static constexpr int SOUTHWEST_SHIFT = StandardGeometry::SOUTHWEST_SHIFT;
+
+static constexpr int HEURISTIC_LINE_COUNT = StandardGeometry::HEURISTIC_LINE_COUNT;
+static constexpr int MAX_LINE_LENGTH = StandardGeometry::MAX_LINE_LENGTH;
+
+static constexpr Score MAX_SCORE = StandardGeometry::MAX_SCORE;
+static constexpr Score MIN_SCORE = StandardGeometry::MIN_SCORE;
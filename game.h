@@ -11,6 +11,7 @@ public:
     void start()
     {
         displayGameStarted();
+        loadOpeningBook();
         chooseSkillLevel();
         choosePlayerToStart();
         displayInitialBoard();
@@ -53,6 +54,12 @@ private:
         _currentPlayer = (_currentPlayer == _ai ? _human : _ai);
     }
 
+    // Mapped before the first play, so the time of the first search is not spent on it.
+    static void loadOpeningBook()
+    {
+        OpeningBook::shared();
+    }
+
     void displayGameStarted()
     {
         cout << "Gamed Started!" << endl << endl;
@@ -89,10 +96,12 @@ private:
         cout << "1 - Novice (depth = 1 on MinMax search)" << endl;
         cout << "2 - Medium (depth = 2)" << endl;
         cout << "3 - Expert (depth = 3)" << endl;
-        cout << "4 - Master (depth = 4)" << endl << endl;
+        cout << "4 - Master (depth = 4)" << endl;
+        cout << "5 - Timed (deepest search in " << DEFAULT_TIME_BUDGET.count() / 1000 << " seconds)" << endl;
+        cout << "6 - Monte Carlo (playouts for " << DEFAULT_TIME_BUDGET.count() / 1000 << " seconds)" << endl << endl;
 
         int skillLevel = 0;
-        while (skillLevel < Novice or skillLevel > Master)
+        while (skillLevel < Novice or skillLevel > MONTE_CARLO_SKILL_LEVEL)
         {
             cout << "Choose the skill level: ";
             cin >> skillLevel;
@@ -100,7 +109,19 @@ private:
 
             if (skillLevel >= Novice and skillLevel <= Master)
             {
-                _ai = shared_ptr<Player> { new AIPlayer { PlayerSkill(skillLevel) } };
+                _ai = ponderingPlayerOf(new AIPlayer { PlayerSkill(skillLevel), threadCount() });
+            }
+            else if (skillLevel == TIMED_SKILL_LEVEL)
+            {
+                _ai = ponderingPlayerOf(new AIPlayer { DEFAULT_TIME_BUDGET, threadCount() });
+            }
+            else if (skillLevel == MONTE_CARLO_SKILL_LEVEL)
+            {
+                MonteCarloSettings settings;
+                settings.playoutBudget = 0;
+                settings.timeBudget = DEFAULT_TIME_BUDGET;
+
+                _ai = shared_ptr<Player> { new MonteCarloPlayer { settings, threadCount() } };
             }
             else
             {
@@ -109,6 +130,20 @@ private:
         }
     }
 
+    // The engine thinks while the user does.
+    static shared_ptr<Player> ponderingPlayerOf(AIPlayer * aiPlayer)
+    {
+        aiPlayer->setPondering(true);
+
+        return shared_ptr<Player> { aiPlayer };
+    }
+
+    // Searches on every core available.
+    static int threadCount()
+    {
+        return imax(1, int(thread::hardware_concurrency()));
+    }
+
     void choosePlayerToStart()
     {
         cout << "1 - Computer" << endl;
@@ -136,6 +171,9 @@ private:
         }
     }
 
+    static constexpr int TIMED_SKILL_LEVEL = Master + 1;
+    static constexpr int MONTE_CARLO_SKILL_LEVEL = TIMED_SKILL_LEVEL + 1;
+
     shared_ptr<Player> _ai { new AIPlayer { Novice } };
     shared_ptr<Player> _human { new HumanPlayer };
     shared_ptr<Player> _currentPlayer;
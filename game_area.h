@@ -2,22 +2,16 @@
 
 #pragma once
 
-static constexpr int LINE_COUNT = 15;
-static constexpr int COLUMN_COUNT = 15;
+#include "board_geometry.h"
 
+// Lines and columns of a board, from start to end; areas running off the board are clipped by BitBoard::of().
 class GameArea
 {
 public:
 
     GameArea(int startLine, int startColumn, int endLine, int endColumn):
         _startLine { imax(0, startLine) }, _startColumn { imax(0, startColumn) },
-        _endLine { imin(endLine, LINE_COUNT - 1) }, _endColumn { imin(endColumn, COLUMN_COUNT - 1) }
-    {
-    }
-
-    GameArea(int start, int length):
-            _startLine { start }, _startColumn { start },
-            _endLine { start + length - 1 }, _endColumn { start + length - 1 }
+        _endLine { endLine }, _endColumn { endColumn }
     {
     }
 
@@ -26,11 +20,6 @@ public:
     int endLine() const { return _endLine; }
     int endColumn() const { return _endColumn; }
 
-    int width() const { return endColumn() - startColumn() + 1; }
-    int height() const { return endLine() - startLine() + 1; }
-
-    int slotCount() const { return width() * height(); }
-
     friend ostream & operator << (ostream & os, const GameArea & area);
 
 private:
@@ -39,12 +28,6 @@ private:
 
 };
 
-static constexpr int WINNING_COUNT = 5;
-static constexpr int FOCUS_LENGTH = 6;
-
-static const GameArea FULL_BOARD { 0, 0, LINE_COUNT - 1, COLUMN_COUNT - 1 };
-static const GameArea CENTRAL_AREA { 3, FOCUS_LENGTH };
-
 inline ostream & operator << (ostream & os, const GameArea & area)
 {
     os << "(" << area._startLine << "," << area._startColumn << "," << area._endLine << "," << area._endColumn << ")";
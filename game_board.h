@@ -2,25 +2,45 @@
 
 #pragma once
 
+#include "debug.h"
 #include "game_slot.h"
-#include "game_position.h"
+#include "symmetry.h"
+#include "zobrist.h"
+#include "line_pattern_table.h"
 
-class GameBoard
+// What GameBoard::undoMove() needs to restore the board as it was before GameBoard::makeMove().
+template <class Geometry>
+struct BasicPlayedMove
+{
+    GamePosition position;
+    PlayerMarker playerMarker;
+    GamePosition previousPosition;
+    bool previousHasWinner;
+    PlayerMarker previousWinner;
+    Score previousHeuristicScore;
+    BasicBitBoard<Geometry> previousCandidates;
+};
+
+// The marks of both players on a board of the given geometry, with what is kept up to date as positions
+// are played: hash keys, heuristic score, candidate positions and the winner.
+template <class Geometry>
+class BasicGameBoard
 {
 public:
 
+    typedef BasicBitBoard<Geometry> BitBoard;
+    typedef BasicPlayedMove<Geometry> PlayedMove;
+
     GamePosition lastPlayedPosition() const { return _lastPlayedPosition; }
 
     bool isGameOver() const
     {
-        return hasWinner() or emptyPositions().size() == 0;
+        return _hasWinner or _markCount == Geometry::LINE_COUNT * Geometry::COLUMN_COUNT;
     }
 
     bool hasWinner() const
     {
-        PlayerMarker playerMarker;
-
-        return victoryFound(playerMarker);
+        return _hasWinner;
     }
 
     bool isDraw() const
@@ -30,89 +50,113 @@ public:
 
     PlayerMarker winner() const
     {
-        PlayerMarker playerMarker;
-
-        if (victoryFound(playerMarker)) return playerMarker;
+        if (_hasWinner) return _winner;
 
         throw runtime_error { "Game has no winner yet." };
     }
 
+    // Terminal state is tracked as positions are played, so no scan of the board is needed here.
     bool victoryFound(PlayerMarker & marker) const
     {
-        // Horizontal
-        for (int line = 0; line < LINE_COUNT; line++)
+        if (_hasWinner)
         {
-            auto start = GamePosition { line, 0 };
-
-            if (victoryFound(start, East, marker))
-            {
-                return true;
-            }
+            marker = _winner;
         }
 
-        // Vertical
-        for (int column = 0; column < COLUMN_COUNT; column++)
-        {
-            auto start = GamePosition { 0, column };
+        return _hasWinner;
+    }
 
-            if (victoryFound(start, South, marker))
-            {
-                return true;
-            }
-        }
+    int markCount() const { return _markCount; }
 
-        // Diagonal - Northeast - Superior
-        for (int line = WINNING_COUNT - 1; line < LINE_COUNT; line++)
-        {
-            auto start = GamePosition { line, 0 };
+    // Zobrist key of the marks on the board, maintained as positions are played.
+    HashKey hashKey() const { return _hashKey; }
+
+    // Key shared by the board and its seven symmetric boards: the lowest of their keys. The symmetry given
+    // takes the board to the one with that key, the canonical form; positions of the canonical form are taken
+    // back by its inverse. Only the opening book needs it, so the keys are computed from the marks on each call.
+    HashKey canonicalKey(int & symmetry) const
+    {
+        HashKey keys[SYMMETRY_COUNT] = {};
 
-            if (victoryFound(start, Northeast, marker))
+        for (const PlayerMarker playerMarker : { X, O })
+        {
+            _marks[playerMarker].forEach([&keys, &playerMarker](const int index)
             {
-                return true;
-            }
+                const BasicZobristKeys<Geometry> & zobristKeys = BasicZobristKeys<Geometry>::shared();
+                const BasicSymmetries<Geometry> & symmetries = BasicSymmetries<Geometry>::shared();
+
+                for (int other = 0; other < SYMMETRY_COUNT; other++)
+                {
+                    keys[other] ^= zobristKeys.keyOf(playerMarker, symmetries.indexOf(other, index));
+                }
+            });
         }
 
-        // Diagonal - Northeast - Inferior
-        for (int column = 1; column < COLUMN_COUNT - WINNING_COUNT; column++)
-        {
-            auto start = GamePosition { LINE_COUNT - 1, column };
+        symmetry = IDENTITY_SYMMETRY;
 
-            if (victoryFound(start, Northeast, marker))
-            {
-                return true;
-            }
+        for (int other = 1; other < SYMMETRY_COUNT; other++)
+        {
+            if (keys[other] < keys[symmetry]) symmetry = other;
         }
 
-        // Diagonal - Southeast - Superior
-        for (int column = 0; column < COLUMN_COUNT - WINNING_COUNT; column++)
+        return keys[symmetry];
+    }
+
+    // Sum of the scores of all heuristic lines; only the lines crossing each position played are scored again.
+    Score heuristicScore() const { return _heuristicScore; }
+
+    bool hasSequenceOf(const int length, const PlayerMarker & playerMarker) const
+    {
+        const BitBoard & marks = _marks[playerMarker];
+
+        return marks.runsOf(length, Geometry::EAST_SHIFT).any() or
+               marks.runsOf(length, Geometry::SOUTH_SHIFT).any() or
+               marks.runsOf(length, Geometry::SOUTHEAST_SHIFT).any() or
+               marks.runsOf(length, Geometry::SOUTHWEST_SHIFT).any();
+    }
+
+    // Empty positions where the player would complete a winning sequence: each window of WINNING_COUNT
+    // positions on a line, marked by the player on all of them but one, empty, is found by shifting the marks.
+    BitBoard winningSlotsOf(const PlayerMarker & playerMarker) const
+    {
+        BitBoard result;
+
+        const BitBoard & marks = _marks[playerMarker];
+
+        if (marks.count() < Geometry::WINNING_COUNT - 1) return result;
+
+        const BitBoard empty = emptySlotsIn();
+
+        for (const int shift : { Geometry::EAST_SHIFT, Geometry::SOUTH_SHIFT, Geometry::SOUTHEAST_SHIFT, Geometry::SOUTHWEST_SHIFT })
         {
-            auto start = GamePosition { 0, column };
+            BitBoard shiftedMarks[Geometry::WINNING_COUNT];
 
-            if (victoryFound(start, Southeast, marker))
+            for (int step = 0; step < Geometry::WINNING_COUNT; step++)
             {
-                return true;
+                shiftedMarks[step] = marks.shiftedDown(step * shift);
             }
-        }
-
-        // Diagonal - Southeast - Inferior
-        for (int line = 1; line < LINE_COUNT - WINNING_COUNT; line++)
-        {
-            auto start = GamePosition { line, 0 };
 
-            if (victoryFound(start, Southeast, marker))
+            for (int emptyStep = 0; emptyStep < Geometry::WINNING_COUNT; emptyStep++)
             {
-                return true;
+                BitBoard starts = empty.shiftedDown(emptyStep * shift);
+
+                for (int step = 0; step < Geometry::WINNING_COUNT and starts.any(); step++)
+                {
+                    if (step != emptyStep) starts = starts & shiftedMarks[step];
+                }
+
+                result = result | starts.shiftedUp(emptyStep * shift);
             }
         }
 
-        return false;
+        return result;
     }
 
     bool victoryFound(const GamePosition & start, const Direction & direction, PlayerMarker & playerMarker) const
     {
         auto current = start;
 
-        while (current.valid())
+        while (BitBoard::contains(current))
         {
             while (emptyIn(current))
             {
@@ -121,7 +165,7 @@ public:
 
             int count = 1;
 
-            while (current.valid())
+            while (BitBoard::contains(current))
             {
                 auto previous = current;
 
@@ -134,7 +178,7 @@ public:
                         throw runtime_error { "Markers should match at this point. " };
                     }
 
-                    if (++count == WINNING_COUNT)
+                    if (++count == Geometry::WINNING_COUNT)
                     {
                         playerMarker = markerInPosition(current);
                         return true;
@@ -152,62 +196,115 @@ public:
 
     PlayerMarker markerInPosition(const GamePosition & position) const
     {
-        if (emptyIn(position))
+        if (not BitBoard::contains(position) or emptyIn(position))
         {
             throw runtime_error { "No player marker available in this position." };
         }
 
-        return _slots[position.line()][position.column()]._playerMarker;
+        return _marks[X].test(BitBoard::indexOf(position)) ? X : O;
     }
 
-    GameBoard play(const GamePosition & position, const PlayerMarker & playerMarker) const
+    BasicGameBoard play(const GamePosition & position, const PlayerMarker & playerMarker) const
     {
         checkRangeOf(position);
 
-        GameBoard newGameBoard { *this };
+        BasicGameBoard newGameBoard { *this };
 
-        newGameBoard._slots[position.line()][position.column()].mark(playerMarker);
+        newGameBoard.mark(position, playerMarker);
 
         newGameBoard._lastPlayedPosition = position;
 
         return newGameBoard;
     }
 
-    vector<GamePosition> emptyPositions(const GameArea &area = FULL_BOARD) const
+    // Plays in place, instead of on a copy like play(); the returned move takes it back on undoMove().
+    PlayedMove makeMove(const GamePosition & position, const PlayerMarker & playerMarker)
     {
-        vector<GamePosition> positions;
+        checkRangeOf(position);
+
+        const PlayedMove playedMove { position, playerMarker, _lastPlayedPosition, _hasWinner, _winner, _heuristicScore, _candidates };
+
+        mark(position, playerMarker);
+
+        _lastPlayedPosition = position;
 
-        for (int line = area.startLine(); line <= area.endLine(); line++)
+        return playedMove;
+    }
+
+    void undoMove(const PlayedMove & playedMove)
+    {
+        const int index = BitBoard::indexOf(playedMove.position);
+
+        _marks[playedMove.playerMarker].reset(index);
+        _markCount--;
+        _hashKey ^= BasicZobristKeys<Geometry>::shared().keyOf(playedMove.playerMarker, index);
+
+        const BasicHeuristicLines<Geometry> & heuristicLines = BasicHeuristicLines<Geometry>::shared();
+
+        for (int axis = 0; axis < AXIS_COUNT; axis++)
         {
-            for (int column = area.startColumn(); column <= area.endColumn(); column++)
+            const LineCrossing & crossing = heuristicLines.crossing(index, axis);
+
+            if (crossing.line >= 0)
             {
-                if (_slots[line][column].empty())
-                {
-                    positions.push_back(GamePosition { line, column });
-                }
+                _linePatterns[crossing.line] -= LinePattern::digitOf(playedMove.playerMarker) * LinePattern::weightOf(crossing.offset);
             }
         }
 
+        _heuristicScore = playedMove.previousHeuristicScore;
+        _candidates = playedMove.previousCandidates;
+
+        _lastPlayedPosition = playedMove.previousPosition;
+        _hasWinner = playedMove.previousHasWinner;
+        _winner = playedMove.previousWinner;
+    }
+
+    vector<GamePosition> emptyPositions(const GameArea & area = BitBoard::fullArea()) const
+    {
+        vector<GamePosition> positions;
+
+        emptySlotsIn(area).forEach([&positions](const int index)
+        {
+            positions.push_back(BitBoard::positionOf(index));
+        });
+
         return positions;
     }
 
+    BitBoard emptySlotsIn(const GameArea & area = BitBoard::fullArea()) const
+    {
+        return ~(_marks[X] | _marks[O]) & BitBoard::of(area);
+    }
+
+    // Empty positions within CANDIDATE_DISTANCE of any mark, kept as positions are played;
+    // on an empty board, just the center.
+    BitBoard candidateSlots() const
+    {
+        if (_markCount > 0) return _candidates;
+
+        BitBoard center;
+        center.set(BitBoard::indexOf(BitBoard::center()));
+
+        return center;
+    }
+
+    const BitBoard & marksOf(const PlayerMarker & playerMarker) const
+    {
+        return _marks[playerMarker];
+    }
+
     bool markedIn(const GamePosition & position, const PlayerMarker & playerMarker) const
     {
-        if (position.valid())
-        {
-            return _slots[position.line()][ position.column()].markedBy(playerMarker);
-        }
-        else
-        {
-            return false;
-        }
+        return _marks[playerMarker].test(position);
     }
 
     bool emptyIn(const GamePosition & position) const
     {
-        if (position.valid())
+        if (BitBoard::contains(position))
         {
-            return _slots[position.line()][position.column()].empty();
+            const int index = BitBoard::indexOf(position);
+
+            return not _marks[X].test(index) and not _marks[O].test(index);
         }
         else
         {
@@ -217,18 +314,15 @@ public:
 
     bool positionsMatch(const GamePosition & left, const GamePosition & right) const
     {
-        if (left.valid() and right.valid() and left != right)
+        if (BitBoard::contains(left) and BitBoard::contains(right) and left != right)
         {
-            const GameSlot leftSlot = _slots[left.line()][left.column()];
-            const GameSlot rightSlot = _slots[right.line()][right.column()];
-
-            if (leftSlot.empty() and rightSlot.empty())
+            if (emptyIn(left) and emptyIn(right))
             {
                 return true; // Should match if both are empty.
             }
             else
             {
-                return leftSlot == rightSlot;
+                return markedIn(left, X) == markedIn(right, X) and markedIn(left, O) == markedIn(right, O);
             }
         }
         else
@@ -239,51 +333,168 @@ public:
 
     bool isClearInAreaForPlay(const GameArea & area, const GamePosition & position) const
     {
-        return position.in(area) and int(emptyPositions(area).size()) == (area.slotCount() - 1);
+        return position.in(area) and emptySlotsIn(area).count() == BitBoard::of(area).count() - 1;
     }
 
-    friend ostream & operator << (ostream &os, const GameBoard &gameBoard);
+    template <class OtherGeometry>
+    friend ostream & operator << (ostream &os, const BasicGameBoard<OtherGeometry> &gameBoard);
 
 private:
 
     void checkRangeOf(const GamePosition &position) const
     {
-        if (position.line() < 0 or position.line() >= LINE_COUNT)
+        if (position.line() < 0 or position.line() >= Geometry::LINE_COUNT)
         {
             throw runtime_error { "Line number out of range" };
         }
 
-        if (position.column() < 0 or position.column() >= COLUMN_COUNT)
+        if (position.column() < 0 or position.column() >= Geometry::COLUMN_COUNT)
         {
             throw runtime_error { "Column number out of range" };
         }
     }
 
-    GameSlot _slots[LINE_COUNT][COLUMN_COUNT];
-    GamePosition _lastPlayedPosition { CENTER };
+    void mark(const GamePosition & position, const PlayerMarker & playerMarker)
+    {
+        const int index = BitBoard::indexOf(position);
+
+        if (_marks[X].test(index) or _marks[O].test(index))
+        {
+            throw "Game slot already marked";
+        }
+
+        _marks[playerMarker].set(index);
+        _markCount++;
+        _hashKey ^= BasicZobristKeys<Geometry>::shared().keyOf(playerMarker, index);
+        _candidates = (_candidates | BitBoard::neighborhoodOf(index)) & ~(_marks[X] | _marks[O]);
+
+        scoreLinesCrossing(index, playerMarker);
+
+        if (not _hasWinner and completesSequence(position, playerMarker))
+        {
+            _hasWinner = true;
+            _winner = playerMarker;
+        }
+    }
+
+    // Only the four lines crossing the position just marked may have been completed by it.
+    bool completesSequence(const GamePosition & position, const PlayerMarker & playerMarker) const
+    {
+        static constexpr Direction forwards[] = { East, South, Southeast, Northeast };
+        static constexpr Direction backwards[] = { West, North, Northwest, Southwest };
+
+        for (int i = 0; i < 4; i++)
+        {
+            const int count = 1 + sequenceLength(position, forwards[i], playerMarker) +
+                                  sequenceLength(position, backwards[i], playerMarker);
+
+            if (count >= Geometry::WINNING_COUNT)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    int sequenceLength(const GamePosition & position, const Direction & direction, const PlayerMarker & playerMarker) const
+    {
+        int length = 0;
+
+        while (length < Geometry::WINNING_COUNT and markedIn(position.neighbor(direction, length + 1), playerMarker))
+        {
+            length++;
+        }
+
+        return length;
+    }
+
+    // A line is scored by looking its new pattern up; the score of its previous pattern is taken off the sum.
+    void scoreLinesCrossing(const int index, const PlayerMarker & playerMarker)
+    {
+        BasicLinePatternTable<Geometry> & patternTable = BasicLinePatternTable<Geometry>::shared();
+        const BasicHeuristicLines<Geometry> & heuristicLines = BasicHeuristicLines<Geometry>::shared();
+
+        int lengths[AXIS_COUNT] = {};
+        uint32_t previousPatterns[AXIS_COUNT] = {};
+        uint32_t currentPatterns[AXIS_COUNT] = {};
+
+        for (int axis = 0; axis < AXIS_COUNT; axis++)
+        {
+            const LineCrossing & crossing = heuristicLines.crossing(index, axis);
+
+            if (crossing.line >= 0)
+            {
+                uint32_t & pattern = _linePatterns[crossing.line];
+
+                lengths[axis] = heuristicLines.line(crossing.line).length;
+                previousPatterns[axis] = pattern;
+
+                pattern += LinePattern::digitOf(playerMarker) * LinePattern::weightOf(crossing.offset);
+
+                currentPatterns[axis] = pattern;
+
+                if (DEBUG<HeuristicDetailedLevel>::enabled)
+                {
+                    cout << "lineScore: " << patternTable.scoreOf(lengths[axis], pattern) << " - line " << crossing.line << " - "
+                         << BitBoard::positionOf(index) << endl;
+                }
+            }
+        }
+
+        _heuristicScore += patternTable.scoreChangeOf(lengths, previousPatterns, currentPatterns);
+    }
+
+    GameSlot slotIn(const int line, const int column) const
+    {
+        GameSlot slot;
+
+        const GamePosition position { line, column };
+
+        if (not emptyIn(position))
+        {
+            slot.mark(markerInPosition(position));
+        }
+
+        return slot;
+    }
+
+    BitBoard _marks[2]; // One set of marked slots per player marker.
+    GamePosition _lastPlayedPosition { BitBoard::center() };
+    int _markCount = 0;
+    HashKey _hashKey = 0;
+    Score _heuristicScore = DRAW;
+    uint32_t _linePatterns[Geometry::HEURISTIC_LINE_COUNT] = {};
+    BitBoard _candidates;
+    bool _hasWinner = false;
+    PlayerMarker _winner = X;
 
 };
 
-ostream & operator << (ostream &os, const GameBoard &gameBoard)
+typedef BasicPlayedMove<StandardGeometry> PlayedMove;
+typedef BasicGameBoard<StandardGeometry> GameBoard;
+
+template <class Geometry>
+ostream & operator << (ostream &os, const BasicGameBoard<Geometry> &gameBoard)
 {
     // Display column letters:
     os << "   ";
-    for (int column = 0; column < COLUMN_COUNT; column++)
+    for (int column = 0; column < Geometry::COLUMN_COUNT; column++)
     {
         os << char('A' + column) << " ";
     }
     os << endl;
 
     // Display actual board:
-    for (int line = 0; line < LINE_COUNT; line++)
+    for (int line = 0; line < Geometry::LINE_COUNT; line++)
     {
         os.width(2);
         os << line + 1 << ' ';
         os.width(0);
 
-        for (int column = 0; column < COLUMN_COUNT; column++)
+        for (int column = 0; column < Geometry::COLUMN_COUNT; column++)
         {
-            os << gameBoard._slots[line][column] << " ";
+            os << gameBoard.slotIn(line, column) << " ";
         }
 
         os << endl;
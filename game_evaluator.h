@@ -0,0 +1,93 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "debug.h"
+#include "score.h"
+#include "game_board.h"
+
+// Utility and heuristic functions of a game board, as seen from a given level of the game tree.
+template <class Geometry>
+class BasicGameEvaluator
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+
+    BasicGameEvaluator(const GameBoard & gameBoard, int level = 0): _gameBoard { gameBoard }, _level { level }
+    {
+    }
+
+    Score scoreFor(const PlayerMarker & playerMarker) const
+    {
+        if (_gameBoard.isGameOver())
+        {
+            return utilityScore();
+        }
+        else
+        {
+            return heuristicScore(playerMarker);
+        }
+    }
+
+    Score utilityScore() const
+    {
+        Score score;
+
+        if (_gameBoard.hasWinner() and _gameBoard.winner() == X)
+        {
+            score = Geometry::MAX_SCORE - _level; // The sooner the victory, the better
+        }
+        else if (_gameBoard.hasWinner())
+        {
+            score = Geometry::MIN_SCORE + _level; // The later the loss, the better
+        }
+        else if (_gameBoard.isDraw())
+        {
+            score = DRAW + _level; // The later the draw, the better
+        }
+        else
+        {
+            throw runtime_error { "The utility score can only be calculated when the game board is terminal." };
+        }
+
+        if (DEBUG<HeuristicLevel>::enabled)
+        {
+            cout << "utilityScore = " << score << " - " << _gameBoard.lastPlayedPosition() << endl;
+        }
+
+        return score;
+    }
+
+    // The board keeps the sum of the scores of each line, scanned for sequences of both players;
+    // see LineEvaluator. It does not depend on the player marker.
+    Score heuristicScore(const PlayerMarker & marker) const
+    {
+        if (DEBUG<HeuristicLevel>::enabled)
+        {
+            cout << "Heuristic of " << marker << " - " << _gameBoard.lastPlayedPosition() << endl;
+        }
+
+        const Score score = _gameBoard.heuristicScore();
+
+        if (DEBUG<HeuristicLevel>::enabled)
+        {
+            cout << "Heuristic Score: " << score << " (" << Geometry::MAX_SCORE - abs(score) << " - " << Geometry::MAX_SCORE << ")" << endl;
+        }
+
+        if (score > Geometry::MAX_SCORE)
+        {
+            throw runtime_error { "No sequences may have score higher than winning score." };
+        }
+
+        return score;
+    }
+
+private:
+
+    const GameBoard & _gameBoard;
+    int _level;
+
+};
+
+typedef BasicGameEvaluator<StandardGeometry> GameEvaluator;
@@ -18,6 +18,7 @@ public:
     int line() const { return _line; }
     int column() const { return _column; }
 
+    // On the standard board; BasicBitBoard::contains() checks a board of any geometry.
     bool valid() const
     {
         return _line >= 0 and _line < LINE_COUNT and _column >= 0 and _column < COLUMN_COUNT;
@@ -37,7 +37,8 @@ public:
         }
     }
 
-    friend class GameBoard;
+    template <class Geometry>
+    friend class BasicGameBoard;
     friend bool operator == (const GameSlot & lhs, const GameSlot & rhs);
 
 private:
@@ -2,72 +2,587 @@
 
 #pragma once
 
+#include <chrono>
+#include <sstream>
+
 #include "game_node.h"
+#include "move_picker.h"
+#include "search_board.h"
+#include "search_memory.h"
+#include "search_statistics.h"
+#include "thread_pool.h"
+#include "transposition_table.h"
+
+// The deadline is checked once every DEADLINE_CHECK_MASK + 1 nodes.
+static constexpr uint64_t DEADLINE_CHECK_MASK = 0xFF;
+
+// Siblings are only searched in parallel on nodes with at least this many levels below them.
+static constexpr int MIN_SPLIT_DEPTH = 2;
+
+// Aspiration windows: the root is first searched within this distance of the expected score - the score
+// of two marks in a row - and the window grows by a power of ten, as scoreOf() does, each time it fails.
+static constexpr Score DEFAULT_ASPIRATION_WINDOW = SINGLE_MARK * SINGLE_MARK;
+static constexpr Score ASPIRATION_WINDOW_GROWTH = SINGLE_MARK;
+
+// A node whose younger siblings are being searched in parallel. Its alpha rises as siblings finish,
+// and a cutoff on it, or on any node above it, tells the siblings still running to give up.
+struct SplitPoint
+{
+    SplitPoint(const SplitPoint * parentSplitPoint, const Score & initialAlpha, const Score & nodeBeta, const int siblingCount):
+        parent { parentSplitPoint }, alpha { initialAlpha }, beta { nodeBeta }, pendingCount { siblingCount }
+    {
+    }
+
+    bool cutoffFound() const
+    {
+        for (const SplitPoint * splitPoint = this; splitPoint != nullptr; splitPoint = splitPoint->parent)
+        {
+            if (splitPoint->cutoff.load(memory_order_relaxed)) return true;
+        }
+
+        return false;
+    }
+
+    const SplitPoint * parent;
+    atomic<Score> alpha;
+    const Score beta;
+    atomic<bool> cutoff { false };
+    atomic<int> pendingCount;
+    mutex resultMutex;
+    int bestMove = -1;
+    vector<int> principalVariation; // From the best move on, once a sibling raises alpha.
+};
+
+// Score of a sibling searched at a split point, the alpha it was searched with, and its principal variation.
+struct SiblingResult
+{
+    Score score = DRAW;
+    Score alpha = MIN_SCORE;
+    bool searched = false;
+    vector<int> principalVariation;
+};
+
+// What one thread needs to search a subtree: its own board, played on in place,
+// the buffers reused at each level, and its own counters.
+template <class Geometry>
+struct BasicSearchContext
+{
+    typedef BasicSearchBoard<Geometry> SearchBoard;
+
+    BasicSearchContext(const SearchBoard & board, const SplitPoint * parentSplitPoint):
+        searchBoard { board }, splitPoint { parentSplitPoint }, rankedPositions { size_t(MAX_SEARCH_DEPTH + 1) },
+        principalVariations { size_t(MAX_SEARCH_DEPTH + 2) }
+    {
+    }
+
+    // Takes the board to the given one, played from the same root board: the moves past the ones they share
+    // are undone, and the moves of the given board past those are played.
+    void moveTo(const SearchBoard & board)
+    {
+        const auto & moves = board.playedMoves();
+        size_t sharedCount = 0;
+
+        while (sharedCount < moves.size() and sharedCount < size_t(searchBoard.ply()) and
+               moves[sharedCount].position == searchBoard.playedMoves()[sharedCount].position and
+               moves[sharedCount].playerMarker == searchBoard.playedMoves()[sharedCount].playerMarker)
+        {
+            sharedCount++;
+        }
 
-class GameTree {
+        while (size_t(searchBoard.ply()) > sharedCount)
+        {
+            searchBoard.undoMove();
+        }
+
+        for (size_t i = sharedCount; i < moves.size(); i++)
+        {
+            searchBoard.makeMove(moves[i].position, moves[i].playerMarker);
+        }
+    }
+
+    SearchBoard searchBoard;
+    const SplitPoint * splitPoint;
+    vector<vector<RankedPosition>> rankedPositions;
+    vector<vector<int>> principalVariations; // Triangular: the best line found from each level down.
+    SearchStatistics statistics;
+};
+
+// The best position found by a search, with its score and principal variation, and what the search did to find it.
+struct SearchResult
+{
+    GamePosition position;
+    Score score;
+    vector<GamePosition> principalVariation;
+    SearchStatistics statistics;
+};
+
+// Searches the best position to play on a board of the given geometry.
+template <class Geometry>
+class BasicGameTree {
 public:
 
-    GameTree(const GameBoard & currentBoard, const GameArea & focus, const int deepestLevel):
-        _root { GameNode { currentBoard }  }, _focus { focus }, _deepestLevel { deepestLevel }
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicBitBoard<Geometry> BitBoard;
+    typedef BasicSearchBoard<Geometry> SearchBoard;
+    typedef BasicSearchContext<Geometry> SearchContext;
+
+    // With a thread pool, the younger siblings of each node are searched in parallel (Young Brothers Wait).
+    BasicGameTree(const GameBoard & currentBoard, const int deepestLevel,
+             const size_t transpositionTableSize = DEFAULT_TRANSPOSITION_TABLE_SIZE,
+             ThreadPool * threadPool = nullptr):
+        _root { SearchBoard { currentBoard }, nullptr }, _deepestLevel { deepestLevel },
+        _transpositionTable { make_shared<TranspositionTable>(transpositionTableSize) }, _threadPool { threadPool },
+        _moveHistory { make_shared<BasicMoveHistory<Geometry>>(MAX_SEARCH_DEPTH + 1) },
+        _threadContexts(threadPool != nullptr ? size_t(threadPool->threadCount()) : 0)
+    {
+    }
+
+    // Searches with what the earlier searches of the game left on the given memory, advanced to the current board:
+    // the transposition table, the move history, and the rest of the principal variation, searched first.
+    BasicGameTree(const GameBoard & currentBoard, const int deepestLevel,
+             const BasicSearchMemory<Geometry> & searchMemory, ThreadPool * threadPool = nullptr):
+        _root { SearchBoard { currentBoard }, nullptr }, _deepestLevel { deepestLevel },
+        _transpositionTable { searchMemory.transpositionTable() }, _threadPool { threadPool },
+        _moveHistory { searchMemory.moveHistory() }, _principalVariation { searchMemory.principalVariationFor(currentBoard) },
+        _threadContexts(threadPool != nullptr ? size_t(threadPool->threadCount()) : 0)
+    {
+    }
+
+    const TranspositionTable & transpositionTable() const { return *_transpositionTable; }
+
+    SearchStatistics statistics() const
+    {
+        lock_guard<mutex> lock { _statisticsMutex };
+
+        return _statistics;
+    }
+
+    TranspositionStatistics transpositionStatistics() const { return statistics().transposition; }
+
+    uint64_t nodeCount() const { return statistics().nodeCount; }
+
+    // Best line of play found by the last completed search, starting with the best position.
+    vector<GamePosition> principalVariation() const
     {
+        vector<GamePosition> variation;
+
+        for (const int index : _principalVariation) variation.push_back(BitBoard::positionOf(index));
+
+        return variation;
     }
 
+    // Depth reached by the last completed search.
+    int completedDepth() const { return _completedDepth; }
+
+    // Score of the best position found by the last completed search.
+    Score completedScore() const { return _completedScore; }
+
+    // Half the width of the first aspiration window; zero searches the root with the whole window.
+    void setAspirationWindow(const Score & window) { _aspirationWindow = window; }
+
+    // Centers the first aspiration window on the given score, such as the one of the previous play.
+    // Later iterations of iterative deepening center it on the score of the previous iteration.
+    void expectScore(const Score & score)
+    {
+        _expectedScore = score;
+        _hasExpectedScore = true;
+    }
+
+    // Searches without writing its progress, or its results, to the console.
+    void setQuiet(const bool quiet) { _quiet = quiet; }
+
+    // Moves the deadline of a search running on another thread, as when a pondering search becomes the real one.
+    void setDeadline(const chrono::steady_clock::time_point & deadline)
+    {
+        _deadline.store(deadline.time_since_epoch().count(), memory_order_relaxed);
+    }
+
+    // Gives up a search running on another thread; it returns the result of the deepest search completed, if any.
+    void stop() { _stopping = true; }
+
     GamePosition bestPositionFor(const PlayerMarker & playerMarker)
     {
-        cout << '[';
-        cout.flush();
+        return search(playerMarker).position;
+    }
+
+    GamePosition bestPositionFor(const PlayerMarker & playerMarker, const chrono::steady_clock::time_point & deadline)
+    {
+        return search(playerMarker, deadline).position;
+    }
+
+    SearchResult search(const PlayerMarker & playerMarker)
+    {
+        GamePosition bestPosition;
+        Score maxScore = Geometry::MIN_SCORE;
 
-        const auto children = _root.childrenFor(playerMarker, _focus);
-        auto bestPosition = children.front().playedPosition();
-        Score maxScore = MIN_SCORE;
+        startStatistics();
 
-        for (const auto & gameNode : children)
+        showProgress('[');
+
+        searchRoot(playerMarker, bestPosition, maxScore);
+
+        showProgress(']');
+
+        finishStatistics();
+
+        if (not _quiet)
         {
-            cout << '.';
-            cout.flush();
+            cout << " (nodes: " << nodeCount() << "; re-searches: " << statistics().aspirationResearchCount;
+            cout << "; reuse hits: " << statistics().transposition.reuseHits << "; pv:" << principalVariationText() << ")" << endl << endl;
+        }
 
-            if (DEBUG<TopLevel>::enabled)
+        if (DEBUG<TopLevel>::enabled)
+        {
+            cout << "AI Played: " << bestPosition << " (max: " << maxScore << ")" << endl << endl;
+        }
+
+        return SearchResult { bestPosition, maxScore, principalVariation(), statistics() };
+    }
+
+    // Iterative deepening: searches depth 1, 2, 3... until the deadline, and plays the best position
+    // of the deepest search completed. Each search is ordered by the principal variation of the previous one.
+    SearchResult search(const PlayerMarker & playerMarker, const chrono::steady_clock::time_point & deadline)
+    {
+        setDeadline(deadline);
+
+        return ponder(playerMarker);
+    }
+
+    // Iterative deepening with no deadline, until one is set by setDeadline(), or the search is stopped.
+    SearchResult ponder(const PlayerMarker & playerMarker)
+    {
+        GamePosition bestPosition;
+        Score maxScore = Geometry::MIN_SCORE;
+
+        startStatistics();
+
+        const int deepestLevel = imin(MAX_SEARCH_DEPTH, _root.searchBoard.gameBoard().emptySlotsIn().count());
+
+        for (int depth = 1; depth <= deepestLevel; depth++)
+        {
+            showProgress('[');
+
+            _deepestLevel = depth;
+            _hasDeadline = depth > 1; // The first search always completes, so there is a position to play.
+
+            const auto start = chrono::steady_clock::now();
+
+            GamePosition position;
+            Score score;
+
+            const bool completed = searchRoot(playerMarker, position, score);
+
+            recordDepthTime(depth, start);
+
+            showProgress(']');
+
+            if (not completed) break;
+
+            bestPosition = position;
+            maxScore = score;
+
+            if (_stopping or chrono::steady_clock::now() >= currentDeadline()) break;
+        }
+
+        _hasDeadline = false;
+
+        finishStatistics();
+
+        if (not _quiet)
+        {
+            cout << " (depth: " << _completedDepth << "; nodes: " << nodeCount() << "; re-searches: " << statistics().aspirationResearchCount;
+            cout << "; reuse hits: " << statistics().transposition.reuseHits << "; pv:" << principalVariationText() << ")" << endl << endl;
+        }
+
+        if (DEBUG<TopLevel>::enabled)
+        {
+            cout << "AI Played: " << bestPosition << " (max: " << maxScore << ")" << endl << endl;
+        }
+
+        return SearchResult { bestPosition, maxScore, principalVariation(), statistics() };
+    }
+
+private:
+
+    // Searches every position at the root down to the deepest level, within the aspiration window,
+    // widened until the score falls inside it. Returns false, leaving the best position untouched,
+    // if stopped by the deadline.
+    bool searchRoot(const PlayerMarker & playerMarker, GamePosition & bestPosition, Score & maxScore)
+    {
+        const int firstMove = _principalVariation.empty() ? -1 : _principalVariation.front();
+        const vector<RankedPosition> positions = rootPositionsFor(firstMove);
+
+        Score window = _aspirationWindow;
+        Score alpha = Geometry::MIN_SCORE;
+        Score beta = Geometry::MAX_SCORE;
+
+        if (_hasExpectedScore and window > 0)
+        {
+            alpha = imax(Geometry::MIN_SCORE, _expectedScore - window);
+            beta = imin(Geometry::MAX_SCORE, _expectedScore + window);
+        }
+
+        GamePosition bestSoFar;
+        Score maxSoFar;
+        vector<int> principalVariation;
+
+        _stopped = false;
+
+        while (true)
+        {
+            _root.statistics.nodeCount++;
+            _root.statistics.plyNodeCounts[0]++;
+            _root.statistics.expansionCount++;
+
+            if (useThreadPool(_root))
             {
-                cout << "GameNode: in: " << gameNode << endl;
+                searchRootInParallel(playerMarker, positions, alpha, beta, bestSoFar, maxSoFar, principalVariation);
             }
+            else
+            {
+                searchRootSerially(playerMarker, positions, alpha, beta, bestSoFar, maxSoFar, principalVariation);
+            }
+
+            if (_stopped) break;
+
+            const bool failedLow = maxSoFar <= alpha and alpha > Geometry::MIN_SCORE;
+            const bool failedHigh = maxSoFar >= beta and beta < Geometry::MAX_SCORE;
+
+            if (not failedLow and not failedHigh) break;
+
+            _root.statistics.aspirationResearchCount++;
+
+            window *= ASPIRATION_WINDOW_GROWTH;
+
+            if (failedLow)
+            {
+                alpha = imax(Geometry::MIN_SCORE, _expectedScore - window);
+            }
+            else
+            {
+                beta = imin(Geometry::MAX_SCORE, _expectedScore + window);
+            }
+        }
+
+        mergeStatistics(_root);
+
+        if (_stopped) return false;
+
+        bestPosition = bestSoFar;
+        maxScore = maxSoFar;
+
+        _completedDepth = _deepestLevel;
+        _completedScore = maxSoFar;
+        _principalVariation = principalVariation;
+
+        expectScore(maxSoFar);
+
+        return true;
+    }
+
+    // Principal Variation Search: a null window proves a position no better than the best so far,
+    // unless it fails high, and then it is searched again with the window left.
+    void searchRootSerially(const PlayerMarker & playerMarker, const vector<RankedPosition> & positions,
+                            const Score & alpha, const Score & beta,
+                            GamePosition & bestSoFar, Score & maxSoFar, vector<int> & principalVariation)
+    {
+        bestSoFar = positions.front().position;
+        maxSoFar = alpha;
+
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            const GamePosition & position = positions[i].position;
+
+            showProgress('.');
+
+            _root.statistics.childCount++;
 
-            const Score score = minMax(gameNode, playerMarker, maxScore, MAX_SCORE);
+            Score score = i == 0 ?
+                searchRootPosition(playerMarker, position, alpha, beta) :
+                searchRootPosition(playerMarker, position, maxSoFar, maxSoFar + 1);
 
-            if (score > maxScore)
+            if (i > 0 and score > maxSoFar and score < beta and not _stopped)
             {
-                maxScore = score;
-                bestPosition = gameNode.playedPosition();
+                score = searchRootPosition(playerMarker, position, maxSoFar, beta);
             }
 
-            if (DEBUG<TopLevel>::enabled)
+            if (not _stopped and score > maxSoFar)
             {
-                cout << "GameNode: out: " << gameNode;
-                cout << " (Score: " << score << "; max: " << maxScore << ")" << endl << endl;
+                maxSoFar = score;
+                bestSoFar = position;
+                principalVariation = variationFrom(position, _root.principalVariations[1]);
+            }
+
+            if (_stopped or maxSoFar >= beta)
+            {
+                if (not _stopped) countCutoff(_root, i);
+
+                break;
             }
         }
+    }
 
-        cout << ']' << endl << endl;
+    // Score of the position played by the given player, as seen by that player.
+    Score searchRootPosition(const PlayerMarker & playerMarker, const GamePosition & position, const Score & alpha, const Score & beta)
+    {
+        _root.searchBoard.makeMove(position, playerMarker);
 
         if (DEBUG<TopLevel>::enabled)
         {
-            cout << "AI Played: " << bestPosition << " (max: " << maxScore << ")" << endl << endl;
+            cout << "GameNode: in: " << currentNode(_root) << endl;
+        }
+
+        const Score score = -negamax(_root, opponentOf(playerMarker), -beta, -alpha);
+
+        if (DEBUG<TopLevel>::enabled)
+        {
+            cout << "GameNode: out: " << currentNode(_root);
+            cout << " (Score: " << score << "; alpha: " << alpha << ")" << endl << endl;
         }
 
-        return bestPosition;
+        _root.searchBoard.undoMove();
+
+        return score;
     }
 
-private:
+    // Picks the same position as the serial search: the first one, in ranking order, with the highest score.
+    void searchRootInParallel(const PlayerMarker & playerMarker, const vector<RankedPosition> & positions,
+                              const Score & alpha, const Score & beta,
+                              GamePosition & bestSoFar, Score & maxSoFar, vector<int> & principalVariation)
+    {
+        vector<SiblingResult> results { positions.size() };
+
+        showProgress('.');
+
+        _root.statistics.childCount++;
+
+        results[0].score = searchRootPosition(playerMarker, positions[0].position, alpha, beta);
+        results[0].alpha = alpha;
+        results[0].searched = true;
+        results[0].principalVariation = variationFrom(positions[0].position, _root.principalVariations[1]);
+
+        if (_stopped) return;
+
+        if (results[0].score < beta)
+        {
+            int bestMove;
+            split(_root, playerMarker, positions, 1, imax(alpha, results[0].score), beta, bestMove, &results);
+
+            if (_stopped) return;
+        }
+
+        size_t best = 0;
+
+        for (size_t i = 1; i < results.size(); i++)
+        {
+            const bool exact = results[i].searched and results[i].score > results[i].alpha;
+
+            if (exact and results[i].score > results[best].score)
+            {
+                best = i;
+            }
+        }
+
+        // A position ranked before the best one, that failed low on exactly the best score, may tie with it.
+        for (size_t i = 1; i < best; i++)
+        {
+            if (results[i].searched and results[i].score <= results[i].alpha and results[i].score == results[best].score)
+            {
+                const Score score = results[best].score;
+
+                if (searchRootPosition(playerMarker, positions[i].position, score - 1, score) >= score)
+                {
+                    best = i;
+                    results[i].principalVariation = variationFrom(positions[i].position, _root.principalVariations[1]);
+                    break;
+                }
+            }
+        }
+
+        maxSoFar = results[best].score;
+        bestSoFar = positions[best].position;
+        principalVariation = results[best].principalVariation;
+    }
+
+    // Checked on every node: the deadline, every few nodes, and cutoffs found by other threads.
+    // The nodes are counted by thread, over all the siblings it searches, however small their subtrees.
+    bool stopRequested(SearchContext & context)
+    {
+        static thread_local uint64_t visitCount = 0;
+
+        SearchStatistics & statistics = context.statistics;
+
+        statistics.plyNodeCounts[level(context)]++;
+        statistics.nodeCount++;
+
+        if ((++visitCount & DEADLINE_CHECK_MASK) == 0 and not _stopped)
+        {
+            if (_stopping or (_hasDeadline and chrono::steady_clock::now() >= currentDeadline()))
+            {
+                _stopped = true;
+            }
+        }
+
+        return aborted(context);
+    }
+
+    chrono::steady_clock::time_point currentDeadline() const
+    {
+        return chrono::steady_clock::time_point { chrono::steady_clock::duration { _deadline.load(memory_order_relaxed) } };
+    }
+
+    // A search given up on: its result is discarded, and not stored on the transposition table.
+    bool aborted(const SearchContext & context) const
+    {
+        return _stopped or (context.splitPoint != nullptr and context.splitPoint->cutoffFound());
+    }
+
+    // True while the positions played so far are the ones of the previous principal variation.
+    bool onPrincipalVariation(const SearchContext & context) const
+    {
+        const auto & playedMoves = context.searchBoard.playedMoves();
+
+        if (playedMoves.size() >= _principalVariation.size()) return false;
+
+        for (size_t i = 0; i < playedMoves.size(); i++)
+        {
+            if (BitBoard::indexOf(playedMoves[i].position) != _principalVariation[i]) return false;
+        }
+
+        return true;
+    }
 
-    Score minMax(GameNode node, PlayerMarker playerMarker, Score alpha, Score beta)
+    // Negamax: scores are seen by the player to move, so each level negates the score of the level below.
+    // Principal Variation Search: the first position is searched with the whole window; the others with
+    // a null window, which only proves them worse, and are searched again if they turn out better.
+    // Fail-soft: the score may fall outside the window, as a bound tighter than alpha or beta.
+    Score negamax(SearchContext & context, const PlayerMarker & playerToMove, Score alpha, const Score beta)
     {
+        const int nodeLevel = level(context);
+
+        context.principalVariations[size_t(nodeLevel)].clear();
+
+        if (stopRequested(context)) return DRAW; // Discarded by the caller.
+
+        const GameBoard & gameBoard = context.searchBoard.gameBoard();
+
         if (DEBUG<MidLevel>::enabled)
         {
-            cout << "DEBUG: GameNode:" << endl << node << endl << endl;
+            cout << "DEBUG: GameNode:" << endl << currentNode(context) << endl << endl;
         }
 
-        if (node.level() == _deepestLevel or node.isGameOver())
+        if (nodeLevel == _deepestLevel or gameBoard.isGameOver())
         {
-            const Score score = node.scoreFor(playerMarker);
+            if (gameBoard.isGameOver())
+            {
+                context.statistics.terminalCount++;
+            }
+            else
+            {
+                context.statistics.leafCount++;
+            }
+
+            const Score score = scoreSignOf(playerToMove) * BasicGameEvaluator<Geometry> { gameBoard, nodeLevel }.scoreFor(playerToMove);
 
             if (DEBUG<MidLevel>::enabled)
             {
@@ -77,103 +592,445 @@ private:
             return score;
         }
 
-        const PlayerMarker opponent = opponentOf(playerMarker);
-        const vector<GameNode> children = node.childrenFor(opponent, _focus);
+        const HashKey key = hashKeyFor(context, playerToMove);
+        const int depth = _deepestLevel - nodeLevel;
+        const bool principalNode = beta - alpha > 1;
+        int hashMove = -1;
 
-        if (DEBUG<BottomLevel>::enabled)
-        {
-            cout << "minMax: in: " << node << endl;
-        }
+        TranspositionEntry entry;
 
-        Score score;
-        if (maxTurn(opponent))
+        if (_transpositionTable->probe(key, entry, context.statistics.transposition))
         {
-            score = max(children, opponent, alpha, beta);
+            hashMove = entry.bestMove;
+
+            // Not on the principal variation, whose line would be cut short.
+            if (not principalNode and entry.depth >= depth)
+            {
+                const Score score = searchScoreOf(entry.score, nodeLevel);
+
+                if (entry.bound == ExactBound or
+                    (entry.bound == LowerBound and score >= beta) or
+                    (entry.bound == UpperBound and score <= alpha))
+                {
+                    return score;
+                }
+            }
         }
-        else
+
+        if (onPrincipalVariation(context))
         {
-            score = min(children, opponent, alpha, beta);
+            hashMove = _principalVariation[size_t(nodeLevel)]; // Searched first, as in the previous iteration.
         }
 
         if (DEBUG<BottomLevel>::enabled)
         {
-            cout << "minMax: out: " << node << " - score: " << score << endl;
+            cout << "negamax: in (" << playerToMove << ": " << alpha << "," << beta << "): " << currentNode(context) << endl;
         }
 
-        return score;
-    }
+        context.statistics.expansionCount++;
 
-    Score max(vector<GameNode> children, PlayerMarker playerMarker, Score alpha, Score beta)
-    {
-        if (DEBUG<BottomLevel>::enabled)
-        {
-            cout << "max: in (" << playerMarker << ": " << alpha << "," << beta << ")" << endl;
-        }
+        const Score originalAlpha = alpha;
+        const PlayerMarker opponent = opponentOf(playerToMove);
+        BasicMovePicker<Geometry> movePicker { gameBoard, playerToMove, hashMove, *_moveHistory, nodeLevel,
+                                               context.rankedPositions[size_t(nodeLevel)] };
 
-        for (const auto & gameNode : children)
+        int bestMove = -1;
+        Score bestScore = Geometry::MIN_SCORE;
+
+        GamePosition position;
+
+        for (size_t i = 0; ; i++)
         {
-            const Score score = minMax(gameNode, playerMarker, alpha, beta);
+            if (i == 1 and useThreadPool(context))
+            {
+                const vector<RankedPosition> & positions = movePicker.remaining();
+
+                if (movePicker.pickedCount() < positions.size())
+                {
+                    alpha = split(context, playerToMove, positions, movePicker.pickedCount(), alpha, beta, bestMove, nullptr);
+                    bestScore = imax(bestScore, alpha);
+                }
+
+                break;
+            }
+
+            if (not movePicker.next(position)) break;
+
+            context.statistics.childCount++;
+            context.searchBoard.makeMove(position, playerToMove);
+
+            Score score;
+
+            if (i == 0)
+            {
+                score = -negamax(context, opponent, -beta, -alpha);
+            }
+            else
+            {
+                score = -negamax(context, opponent, -alpha - 1, -alpha);
+
+                if (score > alpha and score < beta and not aborted(context))
+                {
+                    score = -negamax(context, opponent, -beta, -alpha);
+                }
+            }
+
+            context.searchBoard.undoMove();
+
+            bestScore = imax(bestScore, score);
 
             if (score > alpha)
             {
-                alpha = score; // a better best move for computer
+                alpha = score;
+                bestMove = BitBoard::indexOf(position);
+
+                context.principalVariations[size_t(nodeLevel)] =
+                    variationFrom(position, context.principalVariations[size_t(nodeLevel + 1)]);
             }
 
-            if (alpha >= beta)
+            if (alpha >= beta or aborted(context))
             {
                 if (DEBUG<BottomLevel>::enabled)
                 {
-                    cout << "max: break" << endl;
+                    cout << "negamax: break" << endl;
+                }
+
+                if (not aborted(context))
+                {
+                    cutoffFound(nodeLevel, playerToMove, position);
+                    countCutoff(context, i);
                 }
 
                 break;
             }
         }
 
+        const ScoreBound bound = bestScore <= originalAlpha ? UpperBound : (bestScore >= beta ? LowerBound : ExactBound);
+
+        if (not aborted(context))
+        {
+            _transpositionTable->store(key, tableScoreOf(bestScore, nodeLevel), depth, bound, bestMove, context.statistics.transposition);
+        }
+
         if (DEBUG<BottomLevel>::enabled)
         {
-            cout << "max: out (" << playerMarker << ": " << alpha << "," << beta << ")" << endl;
+            cout << "negamax: out: " << currentNode(context) << " - score: " << bestScore << endl;
         }
 
-        return alpha;
+        return bestScore;
     }
 
-    Score min(vector<GameNode> children, PlayerMarker playerMarker, Score alpha, Score beta)
+    // Young Brothers Wait: once the eldest sibling is searched, the younger ones, from the first position on,
+    // are handed to the thread pool. This thread works on pool tasks until all siblings are done, and
+    // returns the raised alpha, leaving the principal variation of the node on the context.
+    Score split(SearchContext & context, const PlayerMarker & playerMarker, const vector<RankedPosition> & positions,
+                const size_t first, const Score & alpha, const Score & beta, int & bestMove, vector<SiblingResult> * results)
     {
-        if (DEBUG<BottomLevel>::enabled)
+        SplitPoint splitPoint { context.splitPoint, alpha, beta, int(positions.size() - first) };
+        splitPoint.bestMove = bestMove;
+
+        const SearchBoard & searchBoard = context.searchBoard;
+
+        for (size_t i = first; i < positions.size(); i++)
         {
-            cout << "min: in (" << playerMarker << ": " << alpha << "," << beta << ")" << endl;
+            const GamePosition position = positions[i].position;
+            SiblingResult * result = results == nullptr ? nullptr : &(*results)[i];
+
+            _threadPool->submit([this, &splitPoint, &searchBoard, playerMarker, position, i, result]()
+            {
+                searchSibling(splitPoint, searchBoard, playerMarker, position, i, result);
+                splitPoint.pendingCount.fetch_sub(1, memory_order_release);
+            });
         }
 
-        for (const auto & gameNode : children)
+        _threadPool->helpUntil([&splitPoint]() { return splitPoint.pendingCount.load(memory_order_acquire) == 0; });
+
+        bestMove = splitPoint.bestMove;
+
+        if (not splitPoint.principalVariation.empty())
         {
-            const Score score = minMax(gameNode, playerMarker, alpha, beta);
+            context.principalVariations[size_t(level(context))] = splitPoint.principalVariation;
+        }
+
+        return splitPoint.alpha.load();
+    }
+
+    void searchSibling(SplitPoint & splitPoint, const SearchBoard & searchBoard, const PlayerMarker & playerMarker,
+                       const GamePosition & position, const size_t index, SiblingResult * result)
+    {
+        if (_stopped or splitPoint.cutoffFound()) return;
 
-            if (score < beta)
+        SearchContext & context = siblingContextOn(searchBoard, splitPoint);
+
+        const Score alpha = splitPoint.alpha.load();
+        const Score beta = splitPoint.beta;
+
+        if (alpha < beta)
+        {
+            context.statistics.childCount++;
+            context.searchBoard.makeMove(position, playerMarker);
+
+            if (result != nullptr)
             {
-                beta = score;  // a better best move for opponent
+                showProgress('.');
             }
 
-            if (alpha >= beta)
+            const PlayerMarker opponent = opponentOf(playerMarker);
+
+            Score score = -negamax(context, opponent, -alpha - 1, -alpha);
+
+            if (score > alpha and score < beta and not aborted(context))
             {
-                if (DEBUG<BottomLevel>::enabled)
+                score = -negamax(context, opponent, -beta, -alpha);
+            }
+
+            if (not aborted(context))
+            {
+                const vector<int> variation = variationFrom(position, context.principalVariations[size_t(level(context))]);
+
+                lock_guard<mutex> lock { splitPoint.resultMutex };
+
+                if (result != nullptr)
                 {
-                    cout << "min: break" << endl;
+                    *result = SiblingResult { score, alpha, true, variation };
                 }
 
-                break;
+                if (score > splitPoint.alpha)
+                {
+                    splitPoint.alpha = score;
+                    splitPoint.bestMove = BitBoard::indexOf(position);
+                    splitPoint.principalVariation = variation;
+                }
+
+                if (splitPoint.alpha >= splitPoint.beta and not splitPoint.cutoff)
+                {
+                    splitPoint.cutoff = true;
+
+                    cutoffFound(searchBoard.ply(), playerMarker, position);
+                    countCutoff(context, index);
+                }
             }
+
+            context.searchBoard.undoMove();
         }
 
-        if (DEBUG<BottomLevel>::enabled)
+        mergeStatistics(context);
+
+        _threadContexts[size_t(_threadPool->threadIndex())].nestedCount--;
+    }
+
+    // The context of the current thread for a sibling of the split point, taken to the board of the split point.
+    // Each thread keeps one context per sibling nested on it while it helps, reused for the whole search.
+    SearchContext & siblingContextOn(const SearchBoard & searchBoard, const SplitPoint & splitPoint)
+    {
+        ThreadContexts & threadContexts = _threadContexts[size_t(_threadPool->threadIndex())];
+
+        if (threadContexts.nestedCount == threadContexts.contexts.size())
         {
-            cout << "min: out (" << playerMarker << ": " << alpha << "," << beta << ")" << endl;
+            threadContexts.contexts.emplace_back(new SearchContext { searchBoard, &splitPoint });
         }
 
-        return beta;
+        SearchContext & context = *threadContexts.contexts[threadContexts.nestedCount++];
+
+        context.splitPoint = &splitPoint;
+        context.moveTo(searchBoard);
+
+        return context;
+    }
+
+    void cutoffFound(const int nodeLevel, const PlayerMarker & playerMarker, const GamePosition & position)
+    {
+        _moveHistory->cutoffFound(nodeLevel, playerMarker, BitBoard::indexOf(position), _deepestLevel - nodeLevel);
+    }
+
+    bool useThreadPool(const SearchContext & context) const
+    {
+        return _threadPool != nullptr and _threadPool->threadCount() > 1 and _deepestLevel - level(context) >= MIN_SPLIT_DEPTH;
     }
 
-    GameNode _root;
-    GameArea _focus;
+    void mergeStatistics(SearchContext & context)
+    {
+        lock_guard<mutex> lock { _statisticsMutex };
+
+        _statistics += context.statistics;
+
+        context.statistics = SearchStatistics {};
+    }
+
+    void startStatistics()
+    {
+        lock_guard<mutex> lock { _statisticsMutex };
+
+        _statistics = SearchStatistics {};
+        _searchStart = chrono::steady_clock::now();
+    }
+
+    void recordDepthTime(const int depth, const chrono::steady_clock::time_point & start)
+    {
+        lock_guard<mutex> lock { _statisticsMutex };
+
+        _statistics.secondsPerDepth[depth] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    void finishStatistics()
+    {
+        lock_guard<mutex> lock { _statisticsMutex };
+
+        _statistics.completedDepth = _completedDepth;
+        _statistics.seconds = chrono::duration<double>(chrono::steady_clock::now() - _searchStart).count();
+
+        if (_statistics.secondsPerDepth[_completedDepth] == 0)
+        {
+            _statistics.secondsPerDepth[_completedDepth] = _statistics.seconds; // Searched at a fixed depth.
+        }
+    }
+
+    // Counted by the index of the position that caused it, on the order searched.
+    static void countCutoff(SearchContext & context, const size_t index)
+    {
+        context.statistics.cutoffCount++;
+        context.statistics.cutoffIndexCounts[imin(index, size_t(CUTOFF_INDEX_COUNT - 1))]++;
+    }
+
+    // Candidate positions of the root: the hash move first, then by closeness to the last play. Unlike the other
+    // nodes, which pick their positions as they go, the root ranks them all at once: it searches them in parallel,
+    // and keeps the order by closeness, since it plays the first of the positions with the best score.
+    const vector<RankedPosition> & rootPositionsFor(const int hashMove)
+    {
+        const GameBoard & gameBoard = _root.searchBoard.gameBoard();
+
+        GamePosition playedPosition = gameBoard.lastPlayedPosition();
+
+        if (not BitBoard::contains(playedPosition))
+        {
+            playedPosition = BitBoard::center(); // If the game board has not been played yet, we start from the center.
+        }
+
+        auto & positions = _root.rankedPositions[0];
+
+        positions.clear();
+
+        gameBoard.candidateSlots().forEach([&positions, &playedPosition](const int index)
+        {
+            const GamePosition position = BitBoard::positionOf(index);
+
+            positions.push_back(RankedPosition { 0, playedPosition.distanceTo(position), position });
+        });
+
+        sort(positions.begin(), positions.end(), [](const RankedPosition & left, const RankedPosition & right)
+        {
+            return left.distance < right.distance;
+        });
+
+        moveToFront(positions, hashMove);
+
+        return positions;
+    }
+
+    static void moveToFront(vector<RankedPosition> & positions, const int index)
+    {
+        if (index < 0) return;
+
+        const auto found = find_if(positions.begin(), positions.end(), [index](const RankedPosition & ranked)
+        {
+            return BitBoard::indexOf(ranked.position) == index;
+        });
+
+        if (found != positions.end())
+        {
+            rotate(positions.begin(), found, found + 1);
+        }
+    }
+
+    // A dot for each position searched at the root, in brackets for each search.
+    void showProgress(const char mark) const
+    {
+        if (_quiet) return;
+
+        cout << mark;
+        cout.flush();
+    }
+
+    // The given position followed by the best line found after it.
+    static vector<int> variationFrom(const GamePosition & position, const vector<int> & continuation)
+    {
+        vector<int> variation { BitBoard::indexOf(position) };
+
+        variation.insert(variation.end(), continuation.begin(), continuation.end());
+
+        return variation;
+    }
+
+    string principalVariationText() const
+    {
+        ostringstream text;
+
+        for (const GamePosition & position : principalVariation()) text << ' ' << position;
+
+        return text.str();
+    }
+
+    static int level(const SearchContext & context) { return context.searchBoard.ply(); }
+
+    // Victories and losses are scored by the level they are reached on, counted from the root; the table keeps them
+    // counted from the node stored instead, so they still hold when the node is reached on another level or search.
+    static bool decisive(const Score & score) { return abs(score) >= Geometry::MAX_SCORE - MAX_SEARCH_DEPTH; }
+
+    static Score tableScoreOf(const Score & score, const int nodeLevel)
+    {
+        if (not decisive(score)) return score;
+
+        return score > 0 ? score + nodeLevel : score - nodeLevel;
+    }
+
+    static Score searchScoreOf(const Score & score, const int nodeLevel)
+    {
+        if (not decisive(score)) return score;
+
+        return score > 0 ? score - nodeLevel : score + nodeLevel;
+    }
+
+    static HashKey hashKeyFor(const SearchContext & context, const PlayerMarker & playerToMove)
+    {
+        return context.searchBoard.gameBoard().hashKey() ^ (playerToMove == O ? BasicZobristKeys<Geometry>::shared().sideKey() : 0);
+    }
+
+    static BasicGameNode<Geometry> currentNode(const SearchContext & context)
+    {
+        return BasicGameNode<Geometry> { context.searchBoard.gameBoard(), level(context) };
+    }
+
+    // Contexts of the siblings searched by a thread of the pool; see siblingContextOn().
+    struct ThreadContexts
+    {
+        vector<unique_ptr<SearchContext>> contexts;
+        size_t nestedCount = 0;
+    };
+
+    SearchContext _root;
     int _deepestLevel;
+    shared_ptr<TranspositionTable> _transpositionTable;
+    ThreadPool * _threadPool;
+    shared_ptr<BasicMoveHistory<Geometry>> _moveHistory;
+    vector<int> _principalVariation;
+    vector<ThreadContexts> _threadContexts; // By thread index on the pool.
+    int _completedDepth = 0;
+    Score _completedScore = DRAW;
+
+    Score _aspirationWindow = DEFAULT_ASPIRATION_WINDOW;
+    Score _expectedScore = DRAW;
+    bool _hasExpectedScore = false;
+
+    bool _quiet = false;
+
+    atomic<chrono::steady_clock::rep> _deadline { chrono::steady_clock::time_point::max().time_since_epoch().count() };
+    bool _hasDeadline = false;
+    atomic<bool> _stopped { false };
+    atomic<bool> _stopping { false }; // Asked by stop(); _stopped is set by the search itself.
+
+    mutable mutex _statisticsMutex;
+    SearchStatistics _statistics;
+    chrono::steady_clock::time_point _searchStart;
 };
+
+typedef BasicGameTree<StandardGeometry> GameTree;
@@ -0,0 +1,379 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "bit_board.h"
+#include "score.h"
+
+// Each position crosses at most one line on each axis: horizontal, vertical and both diagonals.
+static constexpr int AXIS_COUNT = 4;
+
+// A heuristic line, as BitBoard indexes: from its start, each step moves "shift" bits.
+struct HeuristicLine
+{
+    int start;
+    int shift;
+    int length;
+};
+
+// Where a position is found on a heuristic line.
+struct LineCrossing
+{
+    int line; // -1 if the position is on no heuristic line on this axis.
+    int offset;
+};
+
+// Lines scanned by the heuristic function on a board of the given geometry: every row and column,
+// and the diagonals starting on the positions below (the same ones GameEvaluator has always scanned).
+template <class Geometry>
+class BasicHeuristicLines
+{
+public:
+
+    // The lines of the geometry, computed at compile time.
+    static const BasicHeuristicLines & shared()
+    {
+        static constexpr BasicHeuristicLines lines {};
+
+        return lines;
+    }
+
+    constexpr BasicHeuristicLines(): _lines {}, _crossings {}
+    {
+        for (int index = 0; index < Geometry::BIT_COUNT; index++)
+        {
+            for (int axis = 0; axis < AXIS_COUNT; axis++)
+            {
+                _crossings[index][axis] = LineCrossing { -1, 0 };
+            }
+        }
+
+        int count = 0;
+
+        // Horizontal
+        for (int line = 0; line < Geometry::LINE_COUNT; line++)
+        {
+            add(count++, 0, line, 0, Geometry::EAST_SHIFT, Geometry::COLUMN_COUNT);
+        }
+
+        // Vertical
+        for (int column = 0; column < Geometry::COLUMN_COUNT; column++)
+        {
+            add(count++, 1, 0, column, Geometry::SOUTH_SHIFT, Geometry::LINE_COUNT);
+        }
+
+        // Diagonal - Northeast - Superior
+        for (int line = Geometry::WINNING_COUNT - 1; line < Geometry::LINE_COUNT; line++)
+        {
+            add(count++, 2, line, 0, -Geometry::SOUTHWEST_SHIFT, imin(line + 1, Geometry::COLUMN_COUNT));
+        }
+
+        // Diagonal - Northeast - Inferior
+        for (int column = 1; column < Geometry::COLUMN_COUNT - Geometry::WINNING_COUNT; column++)
+        {
+            add(count++, 2, Geometry::LINE_COUNT - 1, column, -Geometry::SOUTHWEST_SHIFT, imin(Geometry::LINE_COUNT, Geometry::COLUMN_COUNT - column));
+        }
+
+        // Diagonal - Southeast - Superior
+        for (int column = 0; column < Geometry::COLUMN_COUNT - Geometry::WINNING_COUNT; column++)
+        {
+            add(count++, 3, 0, column, Geometry::SOUTHEAST_SHIFT, imin(Geometry::LINE_COUNT, Geometry::COLUMN_COUNT - column));
+        }
+
+        // Diagonal - Southeast - Inferior
+        for (int line = 1; line < Geometry::LINE_COUNT - Geometry::WINNING_COUNT; line++)
+        {
+            add(count++, 3, line, 0, Geometry::SOUTHEAST_SHIFT, imin(Geometry::LINE_COUNT - line, Geometry::COLUMN_COUNT));
+        }
+    }
+
+    constexpr const HeuristicLine & line(const int line) const { return _lines[line]; }
+
+    constexpr const LineCrossing & crossing(const int index, const int axis) const { return _crossings[index][axis]; }
+
+private:
+
+    constexpr void add(const int line, const int axis, const int startLine, const int startColumn, const int shift, const int length)
+    {
+        const int start = startLine * Geometry::BIT_STRIDE + startColumn;
+
+        _lines[line] = HeuristicLine { start, shift, length };
+
+        for (int offset = 0; offset < length; offset++)
+        {
+            _crossings[start + offset * shift][axis] = LineCrossing { line, offset };
+        }
+    }
+
+    HeuristicLine _lines[Geometry::HEURISTIC_LINE_COUNT];
+    LineCrossing _crossings[Geometry::BIT_COUNT][AXIS_COUNT];
+
+};
+
+typedef BasicHeuristicLines<StandardGeometry> HeuristicLines;
+
+// The contents of a line are encoded as a pattern: a base-3 number whose digit at each offset
+// is 0 for an empty position, 1 for X and 2 for O.
+class LinePattern
+{
+public:
+
+    static constexpr uint32_t digitOf(const PlayerMarker & marker)
+    {
+        return marker == X ? 1 : 2;
+    }
+
+    static constexpr uint32_t weightOf(const int offset)
+    {
+        return ipow(uint32_t { 3 }, offset);
+    }
+
+    // Number of patterns of a line with the given length.
+    static constexpr uint32_t countOf(const int length)
+    {
+        return weightOf(length);
+    }
+
+};
+
+// Contents of a single line, scanned by the same rules the heuristic function has always applied
+// on the board: positions off the line (off the board) count as blocked.
+template <class Geometry>
+class BasicLineEvaluator
+{
+public:
+
+    BasicLineEvaluator(const int length, uint32_t pattern): _length { length }
+    {
+        for (int offset = 0; offset < length; offset++)
+        {
+            _cells[offset] = Cell(pattern % 3);
+            pattern /= 3;
+        }
+    }
+
+    Score score() const
+    {
+        Score score = DRAW;
+
+        score += markerScore(X);
+        score += markerScore(O);
+        score += mixedScore(X);
+        score += mixedScore(O);
+
+        return score;
+    }
+
+private:
+
+    enum Cell { EmptyCell, XCell, OCell };
+
+    static constexpr int INVALID_OFFSET = -1;
+
+    bool valid(const int offset) const { return offset >= 0 and offset < _length; }
+
+    bool markedIn(const int offset, const PlayerMarker & marker) const
+    {
+        return valid(offset) and _cells[offset] == (marker == X ? XCell : OCell);
+    }
+
+    bool emptyIn(const int offset) const
+    {
+        return valid(offset) and _cells[offset] == EmptyCell;
+    }
+
+    int findPosition(int current, const PlayerMarker & marker) const
+    {
+        while (valid(current) and not markedIn(current, marker))
+        {
+            current++;
+        }
+
+        return current;
+    }
+
+    Score markerScore(const PlayerMarker & marker) const
+    {
+        Score score = DRAW;
+
+        for (int start = 0; valid(start); )
+        {
+            int end = INVALID_OFFSET;
+            score += markerScore(start, marker, end);
+            start = end;
+        }
+
+        return score;
+    }
+
+    Score markerScore(const int start, const PlayerMarker & marker, int & end) const
+    {
+        int markerCount = 0;
+        int blockedCount = 0;
+        int emptyCount = 0;
+
+        int current = findPosition(start, marker);
+
+        Score score = DRAW;
+        if (markedIn(current, marker))
+        {
+            markerCount++;
+            score += scoreOf(marker, SINGLE_MARK, markerCount);
+        }
+        else
+        {
+            return DRAW;
+        }
+
+        int step = 1;
+        int seqCount = 1;
+        const int base = current;
+
+        while (valid(current) and seqCount < Geometry::WINNING_COUNT)
+        {
+            current = base + step;
+
+            if (step > 0)
+            {
+                end = current;
+            }
+
+            if (markedIn(current, marker))
+            {
+                score += scoreOf(marker, SINGLE_MARK, ++markerCount); // Full score; position already marked.
+                step = step > 0 ? step + 1 : step - 1; // Proceed on the same direction.
+                seqCount++;
+            }
+            else // blocked on this direction - marked positions not found
+            {
+                // A blocked line should be worth less than a free one.
+                if (emptyIn(current))
+                {
+                    score += scoreOf(marker, EMPTY_POSITION, (++emptyCount + markerCount));
+                    seqCount++;
+                }
+                else
+                {
+                    score += scoreOf(opponentOf(marker), BLOCKED, (++blockedCount + markerCount));
+                }
+
+                if (step <= 1)
+                {
+                    // Already blocked on the immediate neighbor, or on the opposite direction; giving up on this direction.
+                    current = INVALID_OFFSET;
+                }
+                else
+                {
+                    // Trying out on the opposite direction.
+                    step = -1;
+                }
+            }
+        }
+
+        if (step < -2)
+        {
+            score = DRAW; // A good chunk of this sequence was in the opposite direction (avoid double-count)
+        }
+
+        return score;
+    }
+
+    Score mixedScore(const PlayerMarker & marker) const
+    {
+        Score score = DRAW;
+
+        for (int start = 0; valid(start); )
+        {
+            int end = INVALID_OFFSET;
+            score += mixedScore(start, marker, end);
+            start = end;
+        }
+
+        return score;
+    }
+
+    Score mixedScore(const int start, const PlayerMarker & marker, int & end) const
+    {
+        int markerCount = 0;
+        int emptyCount = 0;
+        int blockedCount = 0;
+
+        int current = findPosition(start, marker);
+
+        Score score = DRAW;
+        if (markedIn(current, marker))
+        {
+            markerCount++;
+            score += scoreOf(marker, SINGLE_MARK, markerCount);
+        }
+        else
+        {
+            return DRAW;
+        }
+
+        int step = 1;
+        int seqCount = 1;
+        const int base = current;
+
+        while (valid(current) and seqCount < Geometry::WINNING_COUNT)
+        {
+            const int previous = current;
+            current = base + step;
+
+            if (step > 0)
+            {
+                end = current;
+            }
+
+            if (emptyIn(current))
+            {
+                if (emptyIn(previous))
+                {
+                    // Do not count two subsequent empty spaces.
+                    current = INVALID_OFFSET;
+                }
+
+                score += scoreOf(marker, EMPTY_POSITION, (++emptyCount + markerCount)); // half-score; just a possibility at this point.
+                step = step > 0 ? step + 1 : step - 1; // Proceed on the same direction.
+                seqCount++;
+            }
+            else if (markedIn(current, marker))
+            {
+                score += scoreOf(marker, SINGLE_MARK, ++markerCount); // Full score; position already marked.
+                step = step > 0 ? step + 1 : step - 1; // Proceed on the same direction.
+                seqCount++;
+            }
+            else // blocked on this direction
+            {
+                // A blocked line should be worth less than an open one.
+                score += scoreOf(opponentOf(marker), BLOCKED, (++blockedCount + markerCount));
+
+                if (step <= 1)
+                {
+                    // Already blocked on the immediate neighbor, or on the opposite direction; giving up on this direction.
+                    current = INVALID_OFFSET;
+                }
+                else
+                {
+                    // Trying out on the opposite direction.
+                    step = -1;
+                }
+            }
+        }
+
+        if (seqCount != Geometry::WINNING_COUNT or step < -2)
+        {
+            // There are not enough positions available on this direction to win the game,
+            // or a great chunk of it was using the opposite direction (avoid double-count)
+            score = DRAW;
+        }
+
+        return score;
+    }
+
+    Cell _cells[Geometry::MAX_LINE_LENGTH];
+    int _length;
+
+};
+
+typedef BasicLineEvaluator<StandardGeometry> LineEvaluator;
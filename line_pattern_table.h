@@ -0,0 +1,244 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "line_evaluator.h"
+
+// Built by the gomoku_patterns tool; mapped on startup, if found on the working directory.
+static const char * const LINE_PATTERN_FILE = "gomoku_patterns.bin";
+
+// Score of every pattern of every line length the heuristic scans, so scoring a line takes a single load.
+//
+// Patterns are computed by LineEvaluator the first time they are looked up, unless the table
+// was built ahead of time and saved to a file, which is then mapped to memory as is.
+// Each entry keeps (score << 1) | 1, so a zeroed entry marks a pattern not computed yet.
+//
+// Line scores are bounded so the sum of all heuristic lines fits in a Score.
+// Each geometry has its own table, since its winning count changes the scores of the patterns.
+template <class Geometry>
+class BasicLinePatternTable
+{
+public:
+
+    static_assert(Geometry::MAX_LINE_LENGTH <= 19, "Patterns of every line length must be indexed by 31 bits.");
+
+    // The table shared by all boards and threads; only the one of the standard geometry is saved to a file.
+    static BasicLinePatternTable & shared()
+    {
+        static BasicLinePatternTable table { is_same<Geometry, StandardGeometry>::value ? LINE_PATTERN_FILE : "" };
+
+        return table;
+    }
+
+    BasicLinePatternTable(const string & path = "")
+    {
+        uint32_t offset = 0;
+
+        for (int length = 0; length <= Geometry::MAX_LINE_LENGTH; length++)
+        {
+            _offsets[length] = offset;
+            offset += LinePattern::countOf(length);
+        }
+
+        _entryCount = offset;
+
+        if (path.empty() or not map(path))
+        {
+            allocate();
+        }
+    }
+
+    BasicLinePatternTable(const BasicLinePatternTable &) = delete;
+    BasicLinePatternTable & operator = (const BasicLinePatternTable &) = delete;
+
+    ~BasicLinePatternTable()
+    {
+        if (_entries != nullptr)
+        {
+            munmap(_mapping, _mappingSize);
+        }
+    }
+
+    bool mapped() const { return _mapped; }
+
+    Score scoreOf(const int length, const uint32_t pattern)
+    {
+        atomic<int32_t> & entry = _entries[_offsets[length] + pattern];
+
+        int32_t value = entry.load(memory_order_relaxed);
+
+        if (value == 0)
+        {
+            const Score score = BasicLineEvaluator<Geometry> { length, pattern }.score();
+
+            if (score < MIN_ENTRY_SCORE or score > MAX_ENTRY_SCORE)
+            {
+                throw runtime_error { "Line score out of the range of the pattern table." };
+            }
+
+            value = score * 2 + 1;
+
+            entry.store(value, memory_order_relaxed);
+        }
+
+        return value >> 1;
+    }
+
+    // Change on the sum of the scores of the lines crossing a position, one per axis,
+    // from their previous patterns to their current ones. Axes crossing no line have length 0.
+    Score scoreChangeOf(const int (&lengths)[AXIS_COUNT],
+                        const uint32_t (&previousPatterns)[AXIS_COUNT], const uint32_t (&currentPatterns)[AXIS_COUNT])
+    {
+        Score change = DRAW;
+
+        for (int axis = 0; axis < AXIS_COUNT; axis++)
+        {
+            change += scoreOf(lengths[axis], currentPatterns[axis]) - scoreOf(lengths[axis], previousPatterns[axis]);
+        }
+
+        return change;
+    }
+
+    // Computes every pattern of every line length; the table can then be saved.
+    void build()
+    {
+        for (int length = 0; length <= Geometry::MAX_LINE_LENGTH; length++)
+        {
+            for (uint32_t pattern = 0; pattern < LinePattern::countOf(length); pattern++)
+            {
+                scoreOf(length, pattern);
+            }
+        }
+    }
+
+    // Writes a table already built to a file that can be mapped on startup.
+    void save(const string & path) const
+    {
+        const int file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+        if (file < 0)
+        {
+            throw runtime_error { "Unable to create pattern file: " + path };
+        }
+
+        const FileHeader header { FILE_MAGIC, _entryCount };
+
+        const bool written = writeAll(file, &header, sizeof(header)) and
+                             writeAll(file, _entries, _entryCount * sizeof(int32_t));
+
+        close(file);
+
+        if (not written)
+        {
+            throw runtime_error { "Unable to write pattern file: " + path };
+        }
+    }
+
+private:
+
+    struct FileHeader
+    {
+        uint64_t magic;
+        uint64_t entryCount;
+    };
+
+    static constexpr uint64_t FILE_MAGIC = 0x31544150554B4D47ULL; // "GMKUPAT1"
+
+    static constexpr Score MAX_ENTRY_SCORE = INT32_MAX / 2 / Geometry::HEURISTIC_LINE_COUNT;
+    static constexpr Score MIN_ENTRY_SCORE = -MAX_ENTRY_SCORE;
+
+    bool map(const string & path)
+    {
+        const int file = open(path.c_str(), O_RDONLY);
+
+        if (file < 0) return false;
+
+        struct stat status;
+
+        const size_t expectedSize = sizeof(FileHeader) + _entryCount * sizeof(int32_t);
+
+        if (fstat(file, &status) != 0 or size_t(status.st_size) != expectedSize)
+        {
+            close(file);
+            return false;
+        }
+
+        // Private mapping: patterns are never written back to the file.
+        void * mapping = mmap(nullptr, expectedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+
+        close(file);
+
+        if (mapping == MAP_FAILED) return false;
+
+        FileHeader header;
+        memcpy(&header, mapping, sizeof(header));
+
+        if (header.magic != FILE_MAGIC or header.entryCount != _entryCount)
+        {
+            munmap(mapping, expectedSize);
+            return false;
+        }
+
+        _mapping = mapping;
+        _mappingSize = expectedSize;
+        _entries = static_cast<atomic<int32_t> *>(static_cast<void *>(static_cast<char *>(mapping) + sizeof(FileHeader)));
+        _mapped = true;
+
+        return true;
+    }
+
+    // Anonymous memory starts zeroed, and pages of patterns never looked up are never touched,
+    // nor reserved: the table of a 19x19 board spans gigabytes, of which a game touches a few pages.
+    void allocate()
+    {
+        _mappingSize = _entryCount * sizeof(int32_t);
+
+        void * mapping = mmap(nullptr, _mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            throw runtime_error { "Unable to allocate the line pattern table." };
+        }
+
+        _mapping = mapping;
+        _entries = static_cast<atomic<int32_t> *>(mapping);
+    }
+
+    static bool writeAll(const int file, const void * data, size_t size)
+    {
+        const char * bytes = static_cast<const char *>(data);
+
+        while (size > 0)
+        {
+            const ssize_t written = write(file, bytes, size);
+
+            if (written <= 0) return false;
+
+            bytes += written;
+            size -= size_t(written);
+        }
+
+        return true;
+    }
+
+    uint32_t _offsets[Geometry::MAX_LINE_LENGTH + 1];
+    uint32_t _entryCount;
+
+    void * _mapping = nullptr;
+    size_t _mappingSize = 0;
+    atomic<int32_t> * _entries = nullptr;
+    bool _mapped = false;
+
+};
+
+typedef BasicLinePatternTable<StandardGeometry> LinePatternTable;
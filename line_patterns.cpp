@@ -0,0 +1,18 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#include "base.h"
+#include "line_pattern_table.h"
+
+// Builds the table of line patterns ahead of time, so the game maps it on startup instead of filling it while it plays.
+int main(int argc, char * argv[])
+{
+    const string path = argc > 1 ? argv[1] : LINE_PATTERN_FILE;
+
+    LinePatternTable table;
+    table.build();
+    table.save(path);
+
+    cout << "Line patterns saved to " << path << endl;
+
+    return 0;
+}
@@ -0,0 +1,488 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include "search_board.h"
+#include "thread_pool.h"
+
+// How the child to descend to is chosen on each node of the tree.
+enum SelectionRule
+{
+    UctSelection, // Upper confidence bound: the average reward, plus an exploration term on the visits alone.
+    PuctSelection // Exploration weighed by a prior from the heuristic score of each child.
+};
+
+// How the games are played out from the leaves of the tree.
+enum PlayoutPolicy
+{
+    RandomPlayouts, // Any candidate position, at random.
+    GuidedPlayouts  // A winning sequence is completed, or else the opponent's blocked; any candidate otherwise.
+};
+
+static constexpr uint64_t DEFAULT_PLAYOUT_BUDGET = 20000;
+
+// Nodes of the arena: a node takes 24 bytes.
+static constexpr size_t DEFAULT_MONTE_CARLO_NODE_CAPACITY = size_t { 1 } << 20;
+
+// Exploration constants, for rewards between zero and one.
+static constexpr double UCT_EXPLORATION = 1.4;
+static constexpr double PUCT_EXPLORATION = 1.5;
+
+// Leaves are expanded on this visit; the ones before are only played out.
+static constexpr uint32_t EXPANSION_VISIT_COUNT = 4;
+
+// Visits added, with no reward, to the nodes on the path of each playout until it is done,
+// so the other threads are steered to other paths meanwhile.
+static constexpr uint32_t VIRTUAL_LOSS = 3;
+
+// Rewards are counted in half points: a win is worth two, a draw one.
+static constexpr uint32_t WIN_REWARD = 2;
+static constexpr uint32_t DRAW_REWARD = 1;
+
+// Budgets and rules of a search; it stops on whichever budget is spent first, unless it is zero.
+struct MonteCarloSettings
+{
+    uint64_t playoutBudget = DEFAULT_PLAYOUT_BUDGET;
+    chrono::milliseconds timeBudget { 0 };
+    SelectionRule selectionRule = PuctSelection;
+    PlayoutPolicy playoutPolicy = GuidedPlayouts;
+    size_t nodeCapacity = DEFAULT_MONTE_CARLO_NODE_CAPACITY;
+    uint32_t seed = 1;
+};
+
+// Monte Carlo tree search: the tree grows one node at a time towards the positions whose playouts
+// rewarded the player to move the most, and the position visited the most from the root is played.
+//
+// Nodes are kept on an arena allocated once per search, the children of a node next to each other,
+// so the selection reads them in a row. With a thread pool, every thread descends the same tree:
+// visits and rewards are atomic counters, and the thread expanding a node publishes its children
+// before any other thread reads them.
+template <class Geometry>
+class BasicMonteCarloTree
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicBitBoard<Geometry> BitBoard;
+    typedef BasicSearchBoard<Geometry> SearchBoard;
+
+    BasicMonteCarloTree(const GameBoard & gameBoard, const MonteCarloSettings & settings, ThreadPool * threadPool = nullptr):
+        _gameBoard { gameBoard }, _settings { settings }, _threadPool { threadPool },
+        _nodes { new MonteCarloNode[imax(settings.nodeCapacity, size_t { 1 })] }, _nodeCapacity { imax(settings.nodeCapacity, size_t { 1 }) }
+    {
+    }
+
+    GamePosition bestPositionFor(const PlayerMarker & playerMarker)
+    {
+        const auto start = chrono::steady_clock::now();
+
+        _playerToMove = playerMarker;
+        _deadline = start + _settings.timeBudget;
+        _startedCount = 0;
+        _playoutCount = 0;
+        _allocatedCount = 1;
+        _arenaFull = false;
+        initialize(root(), -1, 0);
+
+        {
+            SearchBoard searchBoard { _gameBoard };
+            expand(root(), searchBoard, _playerToMove);
+        }
+
+        if (root().childCount == 0)
+        {
+            throw runtime_error { "No position left to play." };
+        }
+
+        const int threadCount = _threadPool != nullptr ? _threadPool->threadCount() : 1;
+
+        if (threadCount > 1)
+        {
+            atomic<int> runningCount { threadCount };
+
+            for (int worker = 1; worker < threadCount; worker++)
+            {
+                _threadPool->submit([this, &runningCount, worker]()
+                {
+                    work(worker);
+                    runningCount--;
+                });
+            }
+
+            work(0);
+            runningCount--;
+
+            _threadPool->helpUntil([&runningCount]() { return runningCount.load() == 0; });
+        }
+        else
+        {
+            work(0);
+        }
+
+        _seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        return BitBoard::positionOf(mostVisitedChildOf(root()).index);
+    }
+
+    uint64_t playoutCount() const { return _playoutCount.load(); }
+
+    size_t nodeCount() const { return _allocatedCount.load(); }
+
+    double seconds() const { return _seconds; }
+
+private:
+
+    enum NodeState : uint8_t { Unexpanded, Expanding, Expanded };
+
+    struct MonteCarloNode
+    {
+        atomic<uint32_t> visitCount;
+        atomic<uint32_t> rewardSum; // For the player who played the position of the node.
+        atomic<uint8_t> state;
+        uint16_t childCount;
+        int16_t index; // BitBoard index of the position played; -1 on the root.
+        uint32_t firstChild; // Children are only read once the state is Expanded.
+        float prior;
+    };
+
+    // Children of a node being expanded, with the heuristic score of the board after each.
+    struct RankedChild
+    {
+        Score score;
+        int index;
+    };
+
+    MonteCarloNode & root() const { return _nodes[0]; }
+
+    static void initialize(MonteCarloNode & node, const int index, const float prior)
+    {
+        node.visitCount.store(0, memory_order_relaxed);
+        node.rewardSum.store(0, memory_order_relaxed);
+        node.state.store(Unexpanded, memory_order_relaxed);
+        node.childCount = 0;
+        node.index = int16_t(index);
+        node.firstChild = 0;
+        node.prior = prior;
+    }
+
+    // Each call claims a playout of the budget.
+    bool budgetSpent()
+    {
+        if (_settings.playoutBudget > 0 and _startedCount.fetch_add(1, memory_order_relaxed) >= _settings.playoutBudget) return true;
+
+        return _settings.timeBudget.count() > 0 and chrono::steady_clock::now() >= _deadline;
+    }
+
+    void work(const int worker)
+    {
+        SearchBoard searchBoard { _gameBoard };
+        mt19937 random { _settings.seed + uint32_t(worker) };
+        vector<MonteCarloNode *> path;
+        vector<RankedChild> children;
+
+        while (not budgetSpent())
+        {
+            iterate(searchBoard, random, path, children);
+            _playoutCount.fetch_add(1, memory_order_relaxed);
+        }
+    }
+
+    // Selection, expansion, playout and backpropagation of a single playout.
+    void iterate(SearchBoard & searchBoard, mt19937 & random, vector<MonteCarloNode *> & path, vector<RankedChild> & children)
+    {
+        MonteCarloNode * node = &root();
+        PlayerMarker playerMarker = _playerToMove;
+
+        path.clear();
+        path.push_back(node);
+        node->visitCount.fetch_add(VIRTUAL_LOSS, memory_order_relaxed);
+
+        while (not searchBoard.gameBoard().isGameOver())
+        {
+            if (node->state.load(memory_order_acquire) != Expanded)
+            {
+                if (_arenaFull.load(memory_order_relaxed)) break;
+
+                // The visits counted include the virtual loss of this one.
+                if (node->visitCount.load(memory_order_relaxed) < EXPANSION_VISIT_COUNT - 1 + VIRTUAL_LOSS) break;
+
+                uint8_t unexpanded = Unexpanded;
+
+                if (not node->state.compare_exchange_strong(unexpanded, Expanding, memory_order_acquire)) break;
+
+                if (not expand(*node, searchBoard, playerMarker, children)) break;
+            }
+
+            node = &selectChildOf(*node);
+            node->visitCount.fetch_add(VIRTUAL_LOSS, memory_order_relaxed);
+            path.push_back(node);
+
+            searchBoard.makeMove(BitBoard::positionOf(node->index), playerMarker);
+            playerMarker = opponentOf(playerMarker);
+        }
+
+        const uint32_t rewardOfX = searchBoard.gameBoard().isGameOver() ?
+            rewardOfXOn(searchBoard.gameBoard()) :
+            playout(searchBoard.gameBoard(), playerMarker, random);
+
+        // The node reached was played by the opponent of the player to move on it; the ones above, in turns.
+        PlayerMarker nodePlayer = opponentOf(playerMarker);
+
+        for (auto current = path.rbegin(); current != path.rend(); ++current)
+        {
+            (*current)->rewardSum.fetch_add(nodePlayer == X ? rewardOfX : WIN_REWARD - rewardOfX, memory_order_relaxed);
+            (*current)->visitCount.fetch_sub(VIRTUAL_LOSS - 1, memory_order_relaxed);
+            nodePlayer = opponentOf(nodePlayer);
+        }
+
+        while (searchBoard.ply() > 0)
+        {
+            searchBoard.undoMove();
+        }
+    }
+
+    void expand(MonteCarloNode & node, SearchBoard & searchBoard, const PlayerMarker & playerMarker)
+    {
+        vector<RankedChild> children;
+
+        node.state.store(Expanding, memory_order_relaxed);
+        expand(node, searchBoard, playerMarker, children);
+    }
+
+    // Children get the candidate positions, but for a winning sequence to complete or the opponent's to block,
+    // ranked by the heuristic score of the board after each; the prior of each is inverse to its rank.
+    // False, with the node left unexpanded, once the arena is full; no leaf is expanded from then on.
+    bool expand(MonteCarloNode & node, SearchBoard & searchBoard, const PlayerMarker & playerMarker, vector<RankedChild> & children)
+    {
+        const GameBoard & gameBoard = searchBoard.gameBoard();
+        const BitBoard wins = gameBoard.winningSlotsOf(playerMarker);
+        const BitBoard blocks = gameBoard.winningSlotsOf(opponentOf(playerMarker));
+        const BitBoard slots = wins.any() ? wins : (blocks.any() ? blocks : gameBoard.candidateSlots());
+        const size_t childCount = size_t(slots.count());
+
+        size_t firstChild = _allocatedCount.load(memory_order_relaxed);
+
+        do
+        {
+            if (childCount == 0 or firstChild + childCount > _nodeCapacity)
+            {
+                if (childCount > 0) _arenaFull.store(true, memory_order_relaxed);
+
+                node.state.store(Unexpanded, memory_order_release);
+                return false;
+            }
+        }
+        while (not _allocatedCount.compare_exchange_weak(firstChild, firstChild + childCount, memory_order_relaxed));
+
+        children.clear();
+
+        slots.forEach([&children, &searchBoard, &playerMarker](const int index)
+        {
+            searchBoard.makeMove(BitBoard::positionOf(index), playerMarker);
+            children.push_back(RankedChild { searchBoard.gameBoard().heuristicScore() * scoreSignOf(playerMarker), index });
+            searchBoard.undoMove();
+        });
+
+        stable_sort(children.begin(), children.end(), [](const RankedChild & left, const RankedChild & right)
+        {
+            return left.score > right.score;
+        });
+
+        double harmonicSum = 0;
+
+        for (size_t rank = 0; rank < children.size(); rank++) harmonicSum += 1.0 / double(rank + 1);
+
+        for (size_t rank = 0; rank < children.size(); rank++)
+        {
+            initialize(_nodes[firstChild + rank], children[rank].index, float(1.0 / (double(rank + 1) * harmonicSum)));
+        }
+
+        node.firstChild = uint32_t(firstChild);
+        node.childCount = uint16_t(children.size());
+        node.state.store(Expanded, memory_order_release);
+
+        return true;
+    }
+
+    MonteCarloNode & selectChildOf(const MonteCarloNode & node) const
+    {
+        const double parentVisits = double(node.visitCount.load(memory_order_relaxed));
+        const double exploration = _settings.selectionRule == UctSelection ?
+            UCT_EXPLORATION * sqrt(log(imax(parentVisits, 1.0))) :
+            PUCT_EXPLORATION * sqrt(parentVisits);
+
+        MonteCarloNode * best = &_nodes[node.firstChild];
+        double bestValue = -1;
+
+        for (uint32_t i = 0; i < node.childCount; i++)
+        {
+            MonteCarloNode & child = _nodes[node.firstChild + i];
+
+            const uint32_t visits = child.visitCount.load(memory_order_relaxed);
+
+            if (visits == 0 and _settings.selectionRule == UctSelection) return child; // Unvisited children come first, by rank.
+
+            const double average = visits == 0 ? 0.5 : double(child.rewardSum.load(memory_order_relaxed)) / double(WIN_REWARD * visits);
+            const double value = _settings.selectionRule == UctSelection ?
+                average + exploration / sqrt(double(visits)) :
+                average + exploration * double(child.prior) / (1 + double(visits));
+
+            if (value > bestValue)
+            {
+                best = &child;
+                bestValue = value;
+            }
+        }
+
+        return *best;
+    }
+
+    const MonteCarloNode & mostVisitedChildOf(const MonteCarloNode & node) const
+    {
+        const MonteCarloNode * best = &_nodes[node.firstChild];
+
+        for (uint32_t i = 1; i < node.childCount; i++)
+        {
+            const MonteCarloNode & child = _nodes[node.firstChild + i];
+
+            if (child.visitCount.load() > best->visitCount.load()) best = &child;
+        }
+
+        return *best;
+    }
+
+    static uint32_t rewardOfXOn(const GameBoard & gameBoard)
+    {
+        if (not gameBoard.hasWinner()) return DRAW_REWARD;
+
+        return gameBoard.winner() == X ? WIN_REWARD : 0;
+    }
+
+    // Plays on bit boards only, to the end of the game; the reward of X.
+    uint32_t playout(const GameBoard & gameBoard, PlayerMarker playerMarker, mt19937 & random) const
+    {
+        const bool guided = _settings.playoutPolicy == GuidedPlayouts;
+
+        BitBoard marks[2] = { gameBoard.marksOf(X), gameBoard.marksOf(O) };
+        BitBoard candidates = gameBoard.candidateSlots();
+        BitBoard wins[2];
+
+        if (guided)
+        {
+            wins[X] = gameBoard.winningSlotsOf(X);
+            wins[O] = gameBoard.winningSlotsOf(O);
+        }
+
+        while (true)
+        {
+            const PlayerMarker opponent = opponentOf(playerMarker);
+
+            if (guided and wins[playerMarker].any()) return playerMarker == X ? WIN_REWARD : 0;
+
+            int index;
+
+            if (guided and wins[opponent].any())
+            {
+                index = wins[opponent].nth(0);
+            }
+            else
+            {
+                const int count = candidates.count();
+
+                if (count == 0) return DRAW_REWARD;
+
+                index = candidates.nth(uniform_int_distribution<int> { 0, count - 1 }(random));
+            }
+
+            marks[playerMarker].set(index);
+
+            if (not guided and completes(marks[playerMarker], index)) return playerMarker == X ? WIN_REWARD : 0;
+
+            const BitBoard occupied = marks[X] | marks[O];
+
+            candidates = (candidates | BitBoard::neighborhoodOf(index)) & ~occupied;
+
+            if (guided)
+            {
+                wins[X].reset(index);
+                wins[O].reset(index);
+                wins[playerMarker] = wins[playerMarker] | winningSlotsThrough(marks[playerMarker], occupied, index);
+            }
+
+            playerMarker = opponent;
+        }
+    }
+
+    // Empty positions on the lines crossing the given one where the marks would complete a winning sequence.
+    static BitBoard winningSlotsThrough(const BitBoard & marks, const BitBoard & occupied, const int index)
+    {
+        BitBoard result;
+
+        for (const int shift : { Geometry::EAST_SHIFT, Geometry::SOUTH_SHIFT, Geometry::SOUTHEAST_SHIFT, Geometry::SOUTHWEST_SHIFT })
+        {
+            for (int step = 1 - Geometry::WINNING_COUNT; step < Geometry::WINNING_COUNT; step++)
+            {
+                const int slot = index + step * shift;
+
+                if (step != 0 and onBoard(slot) and not occupied.test(slot) and
+                    1 + runLength(marks, slot, shift) + runLength(marks, slot, -shift) >= Geometry::WINNING_COUNT)
+                {
+                    result.set(slot);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    static bool completes(const BitBoard & marks, const int index)
+    {
+        for (const int shift : { Geometry::EAST_SHIFT, Geometry::SOUTH_SHIFT, Geometry::SOUTHEAST_SHIFT, Geometry::SOUTHWEST_SHIFT })
+        {
+            if (1 + runLength(marks, index, shift) + runLength(marks, index, -shift) >= Geometry::WINNING_COUNT) return true;
+        }
+
+        return false;
+    }
+
+    // Marks in a row from the position next to the given one, on the direction of the shift;
+    // the padding column is never marked, so no run wraps from one line into the next.
+    static int runLength(const BitBoard & marks, const int index, const int shift)
+    {
+        int length = 0;
+
+        for (int current = index + shift; onBoard(current) and marks.test(current); current += shift)
+        {
+            length++;
+        }
+
+        return length;
+    }
+
+    static bool onBoard(const int index)
+    {
+        return index >= 0 and index < Geometry::BIT_COUNT and BitBoard::allSlots().test(index);
+    }
+
+    const GameBoard _gameBoard;
+    const MonteCarloSettings _settings;
+    ThreadPool * _threadPool;
+
+    unique_ptr<MonteCarloNode[]> _nodes;
+    const size_t _nodeCapacity;
+    atomic<size_t> _allocatedCount { 0 };
+    atomic<bool> _arenaFull { false };
+    atomic<uint64_t> _startedCount { 0 };
+    atomic<uint64_t> _playoutCount { 0 };
+
+    PlayerMarker _playerToMove = X;
+    chrono::steady_clock::time_point _deadline;
+    double _seconds = 0;
+
+};
+
+typedef BasicMonteCarloTree<StandardGeometry> MonteCarloTree;
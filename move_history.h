@@ -0,0 +1,105 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "bit_board.h"
+#include "player_marker.h"
+
+// Killer moves kept on each level of the search.
+static constexpr int KILLER_COUNT = 2;
+
+// What caused beta cutoffs so far on a search, used to order the positions searched next:
+// the killer moves of each level - the latest positions that caused a cutoff there - and
+// the history of each player on each position, which grows with the depth of the cutoffs it caused.
+//
+// Shared by all search threads; counters are relaxed atomics, since a lost update only costs some ordering.
+template <class Geometry>
+class BasicMoveHistory
+{
+public:
+
+    BasicMoveHistory(const int levelCount): _killers { new atomic<int>[size_t(levelCount * KILLER_COUNT)] }, _levelCount { levelCount }
+    {
+        clear();
+    }
+
+    void clear()
+    {
+        for (int i = 0; i < _levelCount * KILLER_COUNT; i++)
+        {
+            _killers[size_t(i)].store(-1, memory_order_relaxed);
+        }
+
+        for (auto & playerHistory : _history)
+        {
+            for (auto & count : playerHistory)
+            {
+                count.store(0, memory_order_relaxed);
+            }
+        }
+    }
+
+    // The game went on by the given number of plays since the last search: its killers move up as many levels,
+    // to the levels of the same positions from the new root, and the history fades, so the latest cutoffs weigh the most.
+    void advance(const int playCount)
+    {
+        if (playCount <= 0) return;
+
+        for (int i = 0; i < _levelCount * KILLER_COUNT; i++)
+        {
+            const int source = i + playCount * KILLER_COUNT;
+
+            _killers[size_t(i)].store(source < _levelCount * KILLER_COUNT ? _killers[size_t(source)].load(memory_order_relaxed) : -1,
+                                      memory_order_relaxed);
+        }
+
+        for (auto & playerHistory : _history)
+        {
+            for (auto & count : playerHistory)
+            {
+                count.store(count.load(memory_order_relaxed) / 2, memory_order_relaxed);
+            }
+        }
+    }
+
+    // BitBoard index of a killer move of the given level, the latest first; -1 if none.
+    int killer(const int level, const int slot) const
+    {
+        return _killers[size_t(level * KILLER_COUNT + slot)].load(memory_order_relaxed);
+    }
+
+    uint32_t historyOf(const PlayerMarker & playerMarker, const int index) const
+    {
+        return _history[playerMarker][index].load(memory_order_relaxed);
+    }
+
+    // The position played by the given player caused a cutoff with the given number of levels below it.
+    void cutoffFound(const int level, const PlayerMarker & playerMarker, const int index, const int depth)
+    {
+        atomic<int> * killers = &_killers[size_t(level * KILLER_COUNT)];
+
+        if (killers[0].load(memory_order_relaxed) != index)
+        {
+            for (int slot = KILLER_COUNT - 1; slot > 0; slot--)
+            {
+                killers[slot].store(killers[slot - 1].load(memory_order_relaxed), memory_order_relaxed);
+            }
+
+            killers[0].store(index, memory_order_relaxed);
+        }
+
+        _history[playerMarker][index].fetch_add(uint32_t(depth * depth), memory_order_relaxed);
+    }
+
+private:
+
+    unique_ptr<atomic<int>[]> _killers;
+    int _levelCount;
+    atomic<uint32_t> _history[2][Geometry::BIT_COUNT];
+
+};
+
+typedef BasicMoveHistory<StandardGeometry> MoveHistory;
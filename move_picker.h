@@ -0,0 +1,210 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+
+#include "game_board.h"
+#include "move_history.h"
+
+// Candidate position for the next play, ranked by the cutoffs it caused so far, then by its distance to the previous play.
+struct RankedPosition
+{
+    uint32_t history;
+    int distance;
+    GamePosition position;
+};
+
+// Positions of the last stage are picked one at a time, each the best of the ones left, this many times;
+// the ones left after that are sorted at once. Most cutoffs come before then.
+static constexpr size_t SELECTED_PICK_COUNT = 3;
+
+// Candidate positions of a node of the search, yielded in stages, each only worked out once the positions
+// of the stages before it are searched without a cutoff:
+//
+// 1. the hash move - the best position found for the node before, or the one of the principal variation;
+// 2. the positions where the player to move wins;
+// 3. the positions where the opponent would win, which must be blocked;
+// 4. the killer moves of the level;
+// 5. the other candidates, by history, then by closeness to the last play.
+//
+// Positions are kept on the buffer given, in the order yielded, so the ones left can be handed over at once.
+template <class Geometry>
+class BasicMovePicker
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicBitBoard<Geometry> BitBoard;
+
+    BasicMovePicker(const GameBoard & gameBoard, const PlayerMarker & playerMarker, const int hashMove,
+                    const BasicMoveHistory<Geometry> & moveHistory, const int level, vector<RankedPosition> & positions):
+        _gameBoard { gameBoard }, _playerMarker { playerMarker }, _hashMove { hashMove },
+        _moveHistory { moveHistory }, _level { level }, _positions { positions }, _left { gameBoard.candidateSlots() }
+    {
+        _positions.clear();
+    }
+
+    // The next position to search, if any is left.
+    bool next(GamePosition & position)
+    {
+        while (_next == _positions.size() and _stage != DoneStage)
+        {
+            addStage();
+        }
+
+        if (_next == _positions.size()) return false;
+
+        if (_next >= _lastStageStart)
+        {
+            pickBest();
+        }
+
+        position = _positions[_next++].position;
+
+        return true;
+    }
+
+    // Every position, in the order they would be yielded; the ones not yielded yet start at pickedCount().
+    const vector<RankedPosition> & remaining()
+    {
+        while (_stage != DoneStage)
+        {
+            addStage();
+        }
+
+        if (_next < _positions.size())
+        {
+            sortFrom(imax(_next, _lastStageStart));
+        }
+
+        _sorted = true;
+
+        return _positions;
+    }
+
+    size_t pickedCount() const { return _next; }
+
+private:
+
+    enum Stage { HashMoveStage, WinningMovesStage, BlockingMovesStage, KillerMovesStage, OtherMovesStage, DoneStage };
+
+    void addStage()
+    {
+        switch (_stage)
+        {
+            case HashMoveStage:
+                add(_hashMove);
+                _stage = WinningMovesStage;
+                break;
+
+            case WinningMovesStage:
+                addAll(_gameBoard.winningSlotsOf(_playerMarker));
+                _stage = BlockingMovesStage;
+                break;
+
+            case BlockingMovesStage:
+                addAll(_gameBoard.winningSlotsOf(opponentOf(_playerMarker)));
+                _stage = KillerMovesStage;
+                break;
+
+            case KillerMovesStage:
+                for (int slot = 0; slot < KILLER_COUNT; slot++)
+                {
+                    add(_moveHistory.killer(_level, slot));
+                }
+                _stage = OtherMovesStage;
+                break;
+
+            case OtherMovesStage:
+                addOthers();
+                _stage = DoneStage;
+                break;
+
+            case DoneStage:
+                break;
+        }
+    }
+
+    void add(const int index)
+    {
+        if (index >= 0 and _left.test(index))
+        {
+            _left.reset(index);
+            _positions.push_back(RankedPosition { 0, 0, BitBoard::positionOf(index) });
+        }
+    }
+
+    void addAll(const BitBoard & slots)
+    {
+        (slots & _left).forEach([this](const int index) { add(index); });
+    }
+
+    void addOthers()
+    {
+        GamePosition playedPosition = _gameBoard.lastPlayedPosition();
+
+        if (not BitBoard::contains(playedPosition))
+        {
+            playedPosition = BitBoard::center();
+        }
+
+        _lastStageStart = _positions.size();
+
+        _left.forEach([this, &playedPosition](const int index)
+        {
+            const GamePosition position = BitBoard::positionOf(index);
+
+            _positions.push_back(RankedPosition { _moveHistory.historyOf(_playerMarker, index), playedPosition.distanceTo(position), position });
+        });
+
+        _left = BitBoard {};
+    }
+
+    void pickBest()
+    {
+        if (_sorted) return;
+
+        if (_next - _lastStageStart >= SELECTED_PICK_COUNT)
+        {
+            sortFrom(_next);
+            _sorted = true;
+            return;
+        }
+
+        auto best = _positions.begin() + long(_next);
+
+        for (auto current = best + 1; current != _positions.end(); ++current)
+        {
+            if (ranksBefore(*current, *best)) best = current;
+        }
+
+        iter_swap(_positions.begin() + long(_next), best);
+    }
+
+    void sortFrom(const size_t first)
+    {
+        sort(_positions.begin() + long(first), _positions.end(), ranksBefore);
+    }
+
+    static bool ranksBefore(const RankedPosition & left, const RankedPosition & right)
+    {
+        return left.history != right.history ? left.history > right.history : left.distance < right.distance;
+    }
+
+    const GameBoard & _gameBoard;
+    const PlayerMarker _playerMarker;
+    const int _hashMove;
+    const BasicMoveHistory<Geometry> & _moveHistory;
+    const int _level;
+
+    vector<RankedPosition> & _positions;
+    BitBoard _left; // Candidates not added to the positions yet.
+    Stage _stage = HashMoveStage;
+    size_t _next = 0;
+    size_t _lastStageStart = SIZE_MAX;
+    bool _sorted = false;
+
+};
+
+typedef BasicMovePicker<StandardGeometry> MovePicker;
@@ -0,0 +1,184 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "game_board.h"
+
+// Built by the gomoku_book tool; mapped on startup, if found on the working directory.
+static const char * const OPENING_BOOK_FILE = "gomoku_book.bin";
+
+// A position played from the book, for the marks on the board and the player to play next.
+struct BookRecord
+{
+    HashKey key;
+    int32_t move; // BitBoard index of the position to play, on the canonical form of the board.
+    Score score; // As seen by the player to play, when the book was built.
+};
+
+static_assert(sizeof(BookRecord) == 16, "Book records are written to the file as they are.");
+
+// Positions to play on the first plays of a game, searched ahead of time.
+//
+// The file keeps its records sorted by key, then by score, the best first; it is mapped to memory
+// as is, and looked up in place by binary search. Without the file, the book is empty.
+class OpeningBook
+{
+public:
+
+    // The book shared by all players.
+    static const OpeningBook & shared()
+    {
+        static const OpeningBook book { OPENING_BOOK_FILE };
+
+        return book;
+    }
+
+    // Key of the canonical form of the board and the player to play next, so a single record covers
+    // the board and its symmetric boards. The symmetry given takes the board to its canonical form.
+    static HashKey keyOf(const GameBoard & gameBoard, const PlayerMarker & playerToMove, int & symmetry)
+    {
+        return gameBoard.canonicalKey(symmetry) ^ (playerToMove == O ? ZobristKeys::shared().sideKey() : 0);
+    }
+
+    // A position of the board as recorded on the book: on the canonical form, taken there by the given symmetry.
+    static int32_t moveOf(const GamePosition & position, const int symmetry)
+    {
+        return Symmetries::shared().indexOf(symmetry, BitBoard::indexOf(position));
+    }
+
+    OpeningBook(const string & path = "")
+    {
+        if (not path.empty())
+        {
+            map(path);
+        }
+    }
+
+    OpeningBook(const OpeningBook &) = delete;
+    OpeningBook & operator = (const OpeningBook &) = delete;
+
+    ~OpeningBook()
+    {
+        if (_mapping != nullptr)
+        {
+            munmap(_mapping, _mappingSize);
+        }
+    }
+
+    bool mapped() const { return _mapping != nullptr; }
+
+    size_t size() const { return _recordCount; }
+
+    // Best position of the book for the given player on the board, if the board is found on it.
+    bool lookup(const GameBoard & gameBoard, const PlayerMarker & playerToMove, GamePosition & position) const
+    {
+        int symmetry;
+        const HashKey key = keyOf(gameBoard, playerToMove, symmetry);
+
+        const BookRecord * end = _records + _recordCount;
+        const BookRecord * record = lower_bound(_records, end, key, [](const BookRecord & left, const HashKey & right)
+        {
+            return left.key < right;
+        });
+
+        const Symmetries & symmetries = Symmetries::shared();
+
+        for (; record != end and record->key == key; record++)
+        {
+            const GamePosition candidate = BitBoard::positionOf(symmetries.indexOf(symmetries.inverseOf(symmetry), record->move));
+
+            if (candidate.valid() and gameBoard.emptyIn(candidate)) // Skips keys colliding with another board.
+            {
+                position = candidate;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Sorts the records as lookup() expects them, and writes them to a file that can be mapped on startup.
+    static void save(const string & path, vector<BookRecord> records)
+    {
+        sort(records.begin(), records.end(), [](const BookRecord & left, const BookRecord & right)
+        {
+            return left.key != right.key ? left.key < right.key : left.score > right.score;
+        });
+
+        const FileHeader header { FILE_MAGIC, records.size() };
+
+        ofstream file { path, ios::binary | ios::trunc };
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(records.data()), streamsize(records.size() * sizeof(BookRecord)));
+
+        if (not file)
+        {
+            throw runtime_error { "Unable to write opening book: " + path };
+        }
+    }
+
+private:
+
+    struct FileHeader
+    {
+        uint64_t magic;
+        uint64_t recordCount;
+    };
+
+    static constexpr uint64_t FILE_MAGIC = 0x314B4F4F424B4D47ULL; // "GMKBOOK1"
+
+    void map(const string & path)
+    {
+        const int file = open(path.c_str(), O_RDONLY);
+
+        if (file < 0) return;
+
+        struct stat status;
+
+        if (fstat(file, &status) != 0 or size_t(status.st_size) < sizeof(FileHeader))
+        {
+            close(file);
+            return;
+        }
+
+        const size_t size = size_t(status.st_size);
+
+        void * mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+
+        close(file);
+
+        if (mapping == MAP_FAILED) return;
+
+        FileHeader header;
+        memcpy(&header, mapping, sizeof(header));
+
+        if (header.magic != FILE_MAGIC or size != sizeof(FileHeader) + header.recordCount * sizeof(BookRecord))
+        {
+            munmap(mapping, size);
+            return;
+        }
+
+        _mapping = mapping;
+        _mappingSize = size;
+        _records = static_cast<const BookRecord *>(static_cast<const void *>(static_cast<const char *>(mapping) + sizeof(FileHeader)));
+        _recordCount = size_t(header.recordCount);
+
+        madvise(mapping, size, MADV_WILLNEED); // Read ahead now, not on the lookups of the first plays.
+    }
+
+    void * _mapping = nullptr;
+    size_t _mappingSize = 0;
+    const BookRecord * _records = nullptr;
+    size_t _recordCount = 0;
+
+};
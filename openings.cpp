@@ -0,0 +1,88 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#include <thread>
+#include <unordered_set>
+
+#include "opening_book.h"
+#include "game_tree.h"
+
+// Plays on the book up to this many marks on the board.
+static constexpr int DEFAULT_BOOK_PLY_COUNT = 4;
+
+// Searched deeper than the deepest skill level, since the book is built once.
+static constexpr int DEFAULT_BOOK_DEPTH = 5;
+
+// Openings of the book: the player of the book plays its best position, searched at the given depth;
+// the opponent plays every candidate position - on the empty board, the center. Boards symmetric to one
+// already on the book are skipped.
+class OpeningBuilder
+{
+public:
+
+    OpeningBuilder(const int plyCount, const int depth):
+        _plyCount { plyCount }, _depth { depth },
+        _threadPool { imax(1, int(thread::hardware_concurrency())) }
+    {
+    }
+
+    void add(const GameBoard & gameBoard, const PlayerMarker & bookPlayer, const PlayerMarker & playerToMove)
+    {
+        if (gameBoard.markCount() >= _plyCount or gameBoard.isGameOver()) return;
+
+        int symmetry;
+        const HashKey key = OpeningBook::keyOf(gameBoard, playerToMove, symmetry);
+
+        if (not _visited[bookPlayer].insert(key).second) return;
+
+        if (playerToMove == bookPlayer)
+        {
+            GameTree gameTree { gameBoard, _depth, DEFAULT_TRANSPOSITION_TABLE_SIZE, &_threadPool };
+
+            const GamePosition position = gameTree.bestPositionFor(playerToMove);
+
+            _records.push_back(BookRecord { key, OpeningBook::moveOf(position, symmetry), gameTree.completedScore() });
+
+            add(gameBoard.play(position, playerToMove), bookPlayer, opponentOf(playerToMove));
+        }
+        else
+        {
+            gameBoard.candidateSlots().forEach([this, &gameBoard, &bookPlayer, &playerToMove](const int index)
+            {
+                add(gameBoard.play(BitBoard::positionOf(index), playerToMove), bookPlayer, opponentOf(playerToMove));
+            });
+        }
+    }
+
+    const vector<BookRecord> & records() const { return _records; }
+
+private:
+
+    int _plyCount;
+    int _depth;
+    ThreadPool _threadPool;
+    unordered_set<HashKey> _visited[2]; // For each player of the book.
+    vector<BookRecord> _records;
+
+};
+
+// Builds the opening book ahead of time, for either player to start: gomoku_book [path] [ply count] [depth]
+int main(int argc, char * argv[])
+{
+    const string path = argc > 1 ? argv[1] : OPENING_BOOK_FILE;
+    const int plyCount = argc > 2 ? stoi(argv[2]) : DEFAULT_BOOK_PLY_COUNT;
+    const int depth = argc > 3 ? stoi(argv[3]) : DEFAULT_BOOK_DEPTH;
+
+    OpeningBuilder builder { plyCount, depth };
+
+    for (const PlayerMarker bookPlayer : { X, O })
+    {
+        builder.add(GameBoard {}, bookPlayer, bookPlayer);
+        builder.add(GameBoard {}, bookPlayer, opponentOf(bookPlayer));
+    }
+
+    OpeningBook::save(path, builder.records());
+
+    cout << builder.records().size() << " book positions saved to " << path << endl;
+
+    return 0;
+}
@@ -2,8 +2,13 @@
 
 #pragma once
 
+#include <sstream>
+
 #include "game_board.h"
 #include "game_tree.h"
+#include "monte_carlo_tree.h"
+#include "opening_book.h"
+#include "threat_solver.h"
 
 class Player
 {
@@ -19,12 +24,16 @@ public:
 
     virtual GameBoard play(GameBoard & gameBoard) = 0;
 
+    // Plays without writing anything to the console, as when engines play each other.
+    void setQuiet(const bool quiet) { _quiet = quiet; }
+
     friend bool operator == (Player & lhs, Player & rhs);
 
 protected:
 
     const string _name;
     const PlayerMarker _marker;
+    bool _quiet = false;
 
 };
 
@@ -42,41 +51,351 @@ enum PlayerSkill
     Master = 4  // depth = 4
 };
 
+// Time given to each play when the search deepens until the deadline, instead of a fixed depth.
+static constexpr chrono::milliseconds DEFAULT_TIME_BUDGET { 5000 };
+
+// In time-budget mode, the threat solves of each play take at most 1/THREAT_BUDGET_SHARE of the budget.
+static constexpr int THREAT_BUDGET_SHARE = 4;
+
+// With more than one thread, the engines search in parallel on a thread pool kept for the whole game.
+static unique_ptr<ThreadPool> threadPoolOf(const int threadCount)
+{
+    return threadCount > 1 ? unique_ptr<ThreadPool> { new ThreadPool { threadCount } } : nullptr;
+}
+
 class AIPlayer: public Player
 {
 public:
-    AIPlayer(const PlayerSkill & skill): Player { "Exterminator",  X }, _skill { skill }
+    // With more than one thread, the search runs in parallel on a thread pool kept for the whole game.
+    AIPlayer(const PlayerSkill & skill, const int threadCount = 1, const PlayerMarker & marker = X):
+        Player { "Exterminator",  marker }, _skill { skill }, _timeBudget { 0 }, _threadPool { threadPoolOf(threadCount) }
+    {
+    }
+
+    // Time-budget mode: iterative deepening, as deep as the time budget allows on each play.
+    AIPlayer(const chrono::milliseconds & timeBudget, const int threadCount = 1, const PlayerMarker & marker = X):
+        Player { "Exterminator",  marker }, _skill { Master }, _timeBudget { timeBudget }, _threadPool { threadPoolOf(threadCount) }
     {
     }
 
+    ~AIPlayer()
+    {
+        stopPondering();
+    }
+
+    // Searches on the opponent's time: after each play, on the board of the reply the principal variation predicts.
+    // If the opponent plays it, that search becomes the one of the next play; otherwise it is given up,
+    // and only what it left on the search memory is kept.
+    void setPondering(const bool pondering) { _pondering = pondering; }
+
     GameBoard play(GameBoard & gameBoard)
     {
-        checkAndSetFocus(gameBoard.lastPlayedPosition());
+        const auto start = chrono::steady_clock::now();
 
-        GameTree gameTree { gameBoard, focus, _skill };
+        GamePosition bookPosition;
 
-        const GamePosition bestPosition = gameTree.bestPositionFor(_marker);
+        if (OpeningBook::shared().lookup(gameBoard, _marker, bookPosition))
+        {
+            stopPondering();
 
-        cout << "Position Played: " << bestPosition << endl << endl;
+            if (not _quiet)
+            {
+                cout << "Position Played: " << bookPosition << " (opening book)" << endl << endl;
+            }
 
-        return gameBoard.play(bestPosition, _marker);
+            return gameBoard.play(bookPosition, _marker);
+        }
+
+        GamePosition forcedPosition;
+
+        if (forcedPositionOn(gameBoard, start + threatTimeLimit(), forcedPosition))
+        {
+            stopPondering();
+
+            if (not _quiet)
+            {
+                cout << "Position Played: " << forcedPosition << endl << endl;
+            }
+
+            return gameBoard.play(forcedPosition, _marker);
+        }
+
+        SearchResult result;
+
+        if (not ponderedOn(gameBoard, result))
+        {
+            _searchMemory.advanceTo(gameBoard);
+
+            GameTree gameTree { gameBoard, _skill, _searchMemory, _threadPool.get() };
+            gameTree.setQuiet(_quiet);
+
+            if (_hasExpectedScore)
+            {
+                gameTree.expectScore(_expectedScore); // The score of the previous play is the best guess of the next one.
+            }
+
+            result = _timeBudget.count() > 0 ?
+                gameTree.search(_marker, start + _timeBudget) :
+                gameTree.search(_marker);
+        }
+
+        _expectedScore = result.score;
+        _hasExpectedScore = true;
+
+        _searchMemory.remember(gameBoard, _marker, result.principalVariation);
+
+        if (not _quiet)
+        {
+            cout << "Position Played: " << result.position << endl << endl;
+        }
+
+        const GameBoard playedBoard = gameBoard.play(result.position, _marker);
+
+        if (_pondering and result.principalVariation.size() > 1)
+        {
+            startPondering(playedBoard, result.principalVariation[1]);
+        }
+
+        return playedBoard;
     }
 
 private:
 
-    void checkAndSetFocus(const GamePosition & lastPlayedPosition)
+    // Tactical fast path, before the regular search: a win proven by the threat solver is played at once;
+    // against a win proven for the opponent, the position that refutes it, if found. All the solves stop by the deadline.
+    bool forcedPositionOn(const GameBoard & gameBoard, const chrono::steady_clock::time_point & deadline, GamePosition & position) const
+    {
+        if (gameBoard.markCount() == 0) return false;
+
+        vector<GamePosition> sequence;
+        bool settled;
+
+        if (victoryByThreats(gameBoard, _marker, deadline, sequence, settled))
+        {
+            if (not _quiet)
+            {
+                cout << "Forced win:" << sequenceOf(sequence) << endl;
+            }
+
+            position = sequence.front();
+            return true;
+        }
+
+        if (victoryByThreats(gameBoard, opponentOf(_marker), deadline, sequence, settled))
+        {
+            if (not _quiet)
+            {
+                cout << "Forced loss:" << sequenceOf(sequence) << endl;
+            }
+
+            return blockOf(gameBoard, sequence, deadline, position);
+        }
+
+        return false;
+    }
+
+    // Tries the positions of the opponent's proof first, then the other candidates closest to its first move,
+    // until one leaves the opponent no forced win, or the deadline of the threat solves is over.
+    bool blockOf(const GameBoard & gameBoard, const vector<GamePosition> & sequence,
+                 const chrono::steady_clock::time_point & deadline, GamePosition & position) const
+    {
+        if (sequence.size() == 1)
+        {
+            position = sequence.front(); // The opponent completes a sequence next: blocking it is the only move.
+            return true;
+        }
+
+        vector<GamePosition> blocks { sequence };
+
+        vector<GamePosition> others;
+
+        gameBoard.candidateSlots().forEach([&others](const int index)
+        {
+            others.push_back(BitBoard::positionOf(index));
+        });
+
+        sort(others.begin(), others.end(), [&sequence](const GamePosition & left, const GamePosition & right)
+        {
+            return sequence.front().distanceTo(left) < sequence.front().distanceTo(right);
+        });
+
+        blocks.insert(blocks.end(), others.begin(), others.end());
+
+        for (const auto & block : blocks)
+        {
+            if (chrono::steady_clock::now() >= deadline) break;
+
+            if (not gameBoard.emptyIn(block)) continue;
+
+            vector<GamePosition> refuted;
+            bool settled;
+
+            if (not victoryByThreats(gameBoard.play(block, _marker), opponentOf(_marker), deadline, refuted, settled) and settled)
+            {
+                if (not _quiet)
+                {
+                    cout << "Forced block: " << block << endl;
+                }
+
+                position = block;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Victory by threats of the attacker, solved within the limits of this player before the deadline;
+    // the board is left unsettled if a limit is reached first.
+    bool victoryByThreats(const GameBoard & gameBoard, const PlayerMarker & attacker, const chrono::steady_clock::time_point & deadline,
+                          vector<GamePosition> & sequence, bool & settled) const
+    {
+        const auto timeLeft = chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now());
+
+        settled = false;
+
+        if (timeLeft.count() <= 0) return false;
+
+        ThreatSolver threatSolver { gameBoard, threatNodeLimit(), timeLeft };
+
+        const bool found = threatSolver.victoryByThreats(attacker, sequence);
+
+        settled = found or not threatSolver.limitReached();
+
+        return found;
+    }
+
+    // The threat solves of each play share the default limits in proportion to the skill; in time-budget mode,
+    // they also take no more than a share of the budget, which the regular search then goes without.
+    uint64_t threatNodeLimit() const { return DEFAULT_THREAT_NODE_LIMIT * uint64_t(_skill) / Master; }
+
+    chrono::milliseconds threatTimeLimit() const
+    {
+        const chrono::milliseconds limit = DEFAULT_THREAT_TIME_LIMIT * int(_skill) / int(Master);
+
+        return _timeBudget.count() > 0 ? min(limit, _timeBudget / THREAT_BUDGET_SHARE) : limit;
+    }
+
+    // Searches the board after the predicted reply on a thread of its own, quietly.
+    void startPondering(const GameBoard & playedBoard, const GamePosition & predictedReply)
     {
-        if (not lastPlayedPosition.in(focus) or lastPlayedPosition.onFrontierOf(focus))
+        if (playedBoard.isGameOver() or not playedBoard.emptyIn(predictedReply)) return;
+
+        _ponderBoard = playedBoard.play(predictedReply, opponentOf(_marker));
+
+        if (_ponderBoard.isGameOver()) return;
+
+        _searchMemory.advanceTo(_ponderBoard);
+
+        _ponderTree.reset(new GameTree { _ponderBoard, _skill, _searchMemory, _threadPool.get() });
+        _ponderTree->setQuiet(true);
+        _ponderTree->expectScore(_expectedScore);
+        _ponderStart = chrono::steady_clock::now();
+
+        _ponderThread = thread { [this]()
         {
-            int startLine = lastPlayedPosition.line() - FOCUS_LENGTH / 2;
-            int startColumn = lastPlayedPosition.column() - FOCUS_LENGTH / 2;
-            focus = GameArea { startLine, startColumn, startLine + FOCUS_LENGTH, startColumn + FOCUS_LENGTH };
-            cout << "NEW FOCUS: " << focus << endl;
+            _ponderResult = _timeBudget.count() > 0 ? _ponderTree->ponder(_marker) : _ponderTree->search(_marker);
+        }};
+    }
+
+    // On the board pondered, the pondering search is the one of this play: it gets the time budget counted
+    // from when it started, so the time the opponent took is taken off this play; a search at a fixed depth is waited for.
+    bool ponderedOn(const GameBoard & gameBoard, SearchResult & result)
+    {
+        if (_ponderTree == nullptr) return false;
+
+        if (gameBoard.hashKey() != _ponderBoard.hashKey() or gameBoard.markCount() != _ponderBoard.markCount())
+        {
+            stopPondering();
+            return false;
         }
+
+        if (_timeBudget.count() > 0)
+        {
+            _ponderTree->setDeadline(max(_ponderStart + _timeBudget, chrono::steady_clock::now()));
+        }
+
+        _ponderThread.join();
+        _ponderTree.reset();
+
+        result = _ponderResult;
+
+        if (not _quiet)
+        {
+            cout << "Pondered: depth " << result.statistics.completedDepth << "; nodes: " << result.statistics.nodeCount;
+            cout << "; pv:" << sequenceOf(result.principalVariation) << endl << endl;
+        }
+
+        return true;
+    }
+
+    void stopPondering()
+    {
+        if (_ponderTree == nullptr) return;
+
+        _ponderTree->stop();
+        _ponderThread.join();
+        _ponderTree.reset();
+    }
+
+    static string sequenceOf(const vector<GamePosition> & sequence)
+    {
+        ostringstream text;
+
+        for (const auto & position : sequence) text << ' ' << position;
+
+        return text.str();
     }
 
     const PlayerSkill _skill;
-    GameArea focus { CENTRAL_AREA };
+    const chrono::milliseconds _timeBudget;
+    unique_ptr<ThreadPool> _threadPool;
+    SearchMemory _searchMemory; // Of the whole game, shared by the pondering searches.
+    Score _expectedScore = DRAW;
+    bool _hasExpectedScore = false;
+
+    bool _pondering = false;
+    unique_ptr<GameTree> _ponderTree; // Searching on _ponderThread, if any.
+    thread _ponderThread;
+    GameBoard _ponderBoard;
+    SearchResult _ponderResult;
+    chrono::steady_clock::time_point _ponderStart;
+};
+
+// Plays the position visited the most by Monte Carlo tree search, within a playout or time budget;
+// each play starts a new tree.
+class MonteCarloPlayer: public Player
+{
+public:
+
+    MonteCarloPlayer(const MonteCarloSettings & settings, const int threadCount = 1, const PlayerMarker & marker = X):
+        Player { "Exterminator",  marker }, _settings { settings }, _threadPool { threadPoolOf(threadCount) }
+    {
+    }
+
+    GameBoard play(GameBoard & gameBoard)
+    {
+        MonteCarloSettings settings = _settings;
+        settings.seed += uint32_t(gameBoard.markCount()); // Each play draws its own playouts.
+
+        MonteCarloTree monteCarloTree { gameBoard, settings, _threadPool.get() };
+
+        const GamePosition bestPosition = monteCarloTree.bestPositionFor(_marker);
+
+        if (not _quiet)
+        {
+            cout << "Playouts: " << monteCarloTree.playoutCount() << " in " << monteCarloTree.seconds() << "s";
+            cout << " (nodes: " << monteCarloTree.nodeCount() << ")" << endl;
+            cout << "Position Played: " << bestPosition << endl << endl;
+        }
+
+        return gameBoard.play(bestPosition, _marker);
+    }
+
+private:
+
+    const MonteCarloSettings _settings;
+    unique_ptr<ThreadPool> _threadPool;
 };
 
 class HumanPlayer: public Player
@@ -0,0 +1,340 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "search_board.h"
+#include "zobrist.h"
+
+// Limits given to each solve: nodes searched, and bytes taken by the table of proof and disproof numbers.
+static constexpr uint64_t DEFAULT_PROOF_NODE_LIMIT = 2000000;
+static constexpr size_t DEFAULT_PROOF_MEMORY_LIMIT = size_t { 32 } << 20;
+
+// Proof numbers add up on the nodes where every position has to be refuted, so they saturate here.
+static constexpr uint32_t INFINITE_PROOF = uint32_t { 1 } << 30;
+
+// Longest proof line followed on the table, in moves of both players.
+static constexpr int MAX_PROOF_LINE_LENGTH = 64;
+
+// Outcome of a solve, for the player to move.
+enum ProofOutcome
+{
+    ProvenWin,
+    ProvenLoss,
+    Unproven // Stopped by a limit, or neither player can force a win on the candidates searched.
+};
+
+// Depth-first proof-number search (df-pn): proves whether a player, the attacker, can force a win.
+//
+// Each node keeps two numbers: the proof number, the fewest nodes left to prove the goal of the player to move,
+// and the disproof number, the fewest left to refute it. The goal of the attacker is to win; the one of the defender,
+// to keep the attacker from winning. The player to move reaches its goal if any of its positions refutes the goal
+// of the opponent, and fails if all of them prove it; so the proof number of a node is the least disproof number
+// of its children, and the disproof number, the sum of their proof numbers. The search always goes down the most
+// proving child, for as long as its numbers stay under the thresholds of its parent.
+//
+// The attacker only plays on the candidate slots, like the regular search does, which can only miss wins;
+// the defender plays on every empty slot, so a proof holds against any defence. A forced move - completing
+// a winning sequence, or blocking the only one of the opponent - is the single child of its node.
+template <class Geometry>
+class BasicProofNumberSolver
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicBitBoard<Geometry> BitBoard;
+
+    BasicProofNumberSolver(const GameBoard & gameBoard,
+                           const uint64_t nodeLimit = DEFAULT_PROOF_NODE_LIMIT,
+                           const size_t memoryLimit = DEFAULT_PROOF_MEMORY_LIMIT):
+        _searchBoard { gameBoard }, _table(tableSizeFor(memoryLimit)),
+        _moves(Geometry::LINE_COUNT * Geometry::COLUMN_COUNT + 1), _nodeLimit { nodeLimit }
+    {
+    }
+
+    // The player to move is proven to win first, then to lose. On a proof, the line holds the moves
+    // of both players from the board given, the player to move's first, up to the one that wins,
+    // or as far as the table still holds the proof.
+    ProofOutcome solve(const PlayerMarker & playerToMove, vector<GamePosition> & line)
+    {
+        _nodeCount = 0;
+        _limitReached = false;
+        line.clear();
+
+        if (proves(playerToMove, playerToMove, line)) return ProvenWin;
+
+        if (not _limitReached and proves(opponentOf(playerToMove), playerToMove, line)) return ProvenLoss;
+
+        return Unproven;
+    }
+
+    // Whether the last solve was stopped by the node limit.
+    bool limitReached() const { return _limitReached; }
+
+    uint64_t nodeCount() const { return _nodeCount; }
+
+    size_t tableSize() const { return _table.size(); }
+
+private:
+
+    // For the goal of the player to move.
+    struct ProofNumbers
+    {
+        uint32_t proof;
+        uint32_t disproof;
+    };
+
+    struct ProofEntry
+    {
+        HashKey key; // Zero if the entry is empty.
+        ProofNumbers numbers;
+        uint64_t work; // Nodes searched below the position; the entries that took the most are kept.
+    };
+
+    static constexpr ProofNumbers REACHED { 0, INFINITE_PROOF };
+    static constexpr ProofNumbers FAILED { INFINITE_PROOF, 0 };
+    static constexpr ProofNumbers UNSEARCHED { 1, 1 };
+
+    bool proves(const PlayerMarker & attacker, const PlayerMarker & playerToMove, vector<GamePosition> & line)
+    {
+        _attacker = attacker;
+        fill(_table.begin(), _table.end(), ProofEntry {});
+
+        const ProofNumbers root = search(playerToMove, INFINITE_PROOF, INFINITE_PROOF, 0);
+        const bool proven = (playerToMove == attacker ? root.proof : root.disproof) == 0;
+
+        if (proven) followProof(playerToMove, line);
+
+        return proven;
+    }
+
+    ProofNumbers search(const PlayerMarker & playerToMove, const uint32_t proofThreshold, const uint32_t disproofThreshold, const size_t ply)
+    {
+        _nodeCount++;
+
+        const HashKey key = keyOf(_searchBoard.gameBoard().hashKey(), playerToMove);
+        const uint64_t startCount = _nodeCount;
+
+        vector<int> & moves = _moves[ply];
+        ProofNumbers numbers;
+
+        if (settled(playerToMove, moves, numbers))
+        {
+            store(key, numbers, 1);
+            return numbers;
+        }
+
+        const PlayerMarker opponent = opponentOf(playerToMove);
+
+        while (true)
+        {
+            size_t best = 0;
+            ProofNumbers bestNumbers = UNSEARCHED;
+            uint32_t secondDisproof = INFINITE_PROOF;
+
+            numbers = ProofNumbers { INFINITE_PROOF, 0 };
+
+            for (size_t i = 0; i < moves.size(); i++)
+            {
+                const ProofNumbers child = lookup(childKeyOf(key, moves[i], playerToMove)).numbers;
+
+                numbers.disproof = imin(numbers.disproof + child.proof, INFINITE_PROOF);
+
+                if (child.disproof < numbers.proof)
+                {
+                    secondDisproof = numbers.proof;
+                    numbers.proof = child.disproof;
+                    bestNumbers = child;
+                    best = i;
+                }
+                else if (child.disproof < secondDisproof)
+                {
+                    secondDisproof = child.disproof;
+                }
+            }
+
+            if (numbers.proof >= proofThreshold or numbers.disproof >= disproofThreshold) break;
+
+            if (_nodeCount >= _nodeLimit)
+            {
+                _limitReached = true;
+                break;
+            }
+
+            const uint32_t childProofThreshold = imin(disproofThreshold - numbers.disproof + bestNumbers.proof, INFINITE_PROOF);
+            const uint32_t childDisproofThreshold = imin(proofThreshold, secondDisproof + 1);
+
+            _searchBoard.makeMove(BitBoard::positionOf(moves[best]), playerToMove);
+            search(opponent, childProofThreshold, childDisproofThreshold, ply + 1);
+            _searchBoard.undoMove();
+        }
+
+        store(key, numbers, _nodeCount - startCount + 1);
+
+        return numbers;
+    }
+
+    // Numbers of a node decided without searching it: the game is over, a winning sequence can be completed,
+    // or the opponent has more than one to block. Otherwise, the positions to search: the candidate slots
+    // of the attacker, or every empty slot of the defender.
+    bool settled(const PlayerMarker & playerToMove, vector<int> & moves, ProofNumbers & numbers) const
+    {
+        const GameBoard & gameBoard = _searchBoard.gameBoard();
+
+        moves.clear();
+
+        if (gameBoard.hasWinner()) // The opponent has just won.
+        {
+            numbers = FAILED;
+            return true;
+        }
+
+        if (gameBoard.isDraw())
+        {
+            numbers = playerToMove == _attacker ? FAILED : REACHED;
+            return true;
+        }
+
+        const BitBoard wins = gameBoard.winningSlotsOf(playerToMove);
+
+        if (wins.any())
+        {
+            wins.forEach([&moves](const int index) { moves.push_back(index); });
+            numbers = REACHED;
+            return true;
+        }
+
+        const BitBoard blocks = gameBoard.winningSlotsOf(opponentOf(playerToMove));
+
+        if (blocks.count() > 1)
+        {
+            blocks.forEach([&moves](const int index) { moves.push_back(index); });
+            numbers = FAILED;
+            return true;
+        }
+
+        const BitBoard slots = playerToMove == _attacker ? gameBoard.candidateSlots() : gameBoard.emptySlotsIn();
+
+        (blocks.any() ? blocks : slots).forEach([&moves](const int index)
+        {
+            moves.push_back(index);
+        });
+
+        return false;
+    }
+
+    // Down the table from the root: the player reaching its goal plays a position refuting the goal of the opponent;
+    // the one failing it plays the position that took the longest to prove.
+    void followProof(const PlayerMarker & playerToMove, vector<GamePosition> & line)
+    {
+        PlayerMarker playerMarker = playerToMove;
+        vector<int> moves;
+        ProofNumbers numbers;
+
+        line.clear();
+
+        while (int(line.size()) < MAX_PROOF_LINE_LENGTH)
+        {
+            const HashKey key = keyOf(_searchBoard.gameBoard().hashKey(), playerMarker);
+            const bool decided = settled(playerMarker, moves, numbers);
+
+            if (moves.empty()) break;
+
+            int next = -1;
+
+            if (decided) // A winning sequence completed, or one of those that can not all be blocked.
+            {
+                next = moves.front();
+            }
+            else
+            {
+                numbers = lookup(key).numbers;
+
+                if (numbers.proof != 0 and numbers.disproof != 0) break;
+
+                uint64_t longest = 0;
+
+                for (const int index : moves)
+                {
+                    const ProofEntry & child = lookup(childKeyOf(key, index, playerMarker));
+
+                    if (numbers.proof == 0 ? child.numbers.disproof == 0 : (child.numbers.proof == 0 and child.work >= longest))
+                    {
+                        next = index;
+                        longest = child.work;
+
+                        if (numbers.proof == 0) break;
+                    }
+                }
+
+                if (next < 0) break;
+            }
+
+            line.push_back(BitBoard::positionOf(next));
+
+            if (decided and numbers.proof == 0) break;
+
+            _searchBoard.makeMove(line.back(), playerMarker);
+            playerMarker = opponentOf(playerMarker);
+        }
+
+        while (_searchBoard.ply() > 0)
+        {
+            _searchBoard.undoMove();
+        }
+    }
+
+    static HashKey keyOf(const HashKey & boardKey, const PlayerMarker & playerToMove)
+    {
+        return playerToMove == O ? boardKey ^ BasicZobristKeys<Geometry>::shared().sideKey() : boardKey;
+    }
+
+    static HashKey childKeyOf(const HashKey & key, const int index, const PlayerMarker & playerToMove)
+    {
+        return key ^ BasicZobristKeys<Geometry>::shared().keyOf(playerToMove, index) ^ BasicZobristKeys<Geometry>::shared().sideKey();
+    }
+
+    const ProofEntry & lookup(const HashKey & key) const
+    {
+        static const ProofEntry unsearched { 0, UNSEARCHED, 0 };
+
+        const ProofEntry & entry = _table[key & (_table.size() - 1)];
+
+        return entry.key == key ? entry : unsearched;
+    }
+
+    void store(const HashKey & key, const ProofNumbers & numbers, const uint64_t work)
+    {
+        ProofEntry & entry = _table[key & (_table.size() - 1)];
+
+        if (entry.key == key or entry.work <= work)
+        {
+            entry = ProofEntry { key, numbers, work };
+        }
+    }
+
+    // Entries that fit in the memory limit, rounded down to a power of two.
+    static size_t tableSizeFor(const size_t memoryLimit)
+    {
+        size_t result = 1;
+
+        while (result * 2 * sizeof(ProofEntry) <= memoryLimit) result *= 2;
+
+        return result;
+    }
+
+    BasicSearchBoard<Geometry> _searchBoard;
+    vector<ProofEntry> _table;
+    vector<vector<int>> _moves; // Positions of the nodes on the path searched, by ply; one per empty slot at most.
+    const uint64_t _nodeLimit;
+
+    PlayerMarker _attacker = X;
+    uint64_t _nodeCount = 0;
+    bool _limitReached = false;
+
+};
+
+template <class Geometry> constexpr typename BasicProofNumberSolver<Geometry>::ProofNumbers BasicProofNumberSolver<Geometry>::REACHED;
+template <class Geometry> constexpr typename BasicProofNumberSolver<Geometry>::ProofNumbers BasicProofNumberSolver<Geometry>::FAILED;
+template <class Geometry> constexpr typename BasicProofNumberSolver<Geometry>::ProofNumbers BasicProofNumberSolver<Geometry>::UNSEARCHED;
+
+typedef BasicProofNumberSolver<StandardGeometry> ProofNumberSolver;
@@ -2,19 +2,29 @@
 
 #pragma once
 
+#include <cstdint>
+
 #include "integer_math.h"
 #include "player_marker.h"
 
-typedef long Score;
+// 32 bits cover every score: maxScoreOf() and minScoreOf() below are computed as Scores,
+// so the compiler rejects them on overflow; line scores are bounded by LinePatternTable.
+typedef int32_t Score;
 
 constexpr Score scoreOf(const PlayerMarker & playerMarker, const Score & base, const int & seqCount)
 {
     return (playerMarker == X ? +1 : -1) * ipow(base, seqCount);
 }
 
+// Scores are kept from the point of view of X; multiplied by this, from the point of view of the given player.
+constexpr Score scoreSignOf(const PlayerMarker & playerMarker)
+{
+    return playerMarker == X ? +1 : -1;
+}
+
 constexpr Score fullScoreOf(const PlayerMarker & playerMarker, const Score & base, const int & seqCount)
 {
-    int score = 0;
+    Score score = 0;
     int count = seqCount;
 
     while (count > 0)
@@ -31,6 +41,15 @@ constexpr Score EMPTY_POSITION = 2; // An empty position is just a possibility.
 constexpr Score SINGLE_MARK = 10; // A single mark on the game board.
 constexpr Score BLOCKED = 6; // A blocked line should neutralize the effect of the opponent's sequence.
 
-constexpr Score MAX_SCORE = fullScoreOf(X, SINGLE_MARK, WINNING_COUNT + 1);
-constexpr Score MIN_SCORE = fullScoreOf(O, SINGLE_MARK, WINNING_COUNT + 1);
+// Scores of a victory of X and of O, above any heuristic score of a board where that many marks in a row win;
+// see BoardGeometry for the ones of each board.
+constexpr Score maxScoreOf(const int winningCount)
+{
+    return fullScoreOf(X, SINGLE_MARK, winningCount + 1);
+}
+
+constexpr Score minScoreOf(const int winningCount)
+{
+    return fullScoreOf(O, SINGLE_MARK, winningCount + 1);
+}
 
@@ -0,0 +1,51 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "game_board.h"
+
+// The single board a search thread plays on: moves are made and taken back in place,
+// so no board is copied while the game tree is explored.
+template <class Geometry>
+class BasicSearchBoard
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicPlayedMove<Geometry> PlayedMove;
+
+    BasicSearchBoard(const GameBoard & gameBoard): _gameBoard { gameBoard }
+    {
+        _playedMoves.reserve(Geometry::LINE_COUNT * Geometry::COLUMN_COUNT);
+    }
+
+    const GameBoard & gameBoard() const { return _gameBoard; }
+
+    int ply() const { return int(_playedMoves.size()); }
+
+    const vector<PlayedMove> & playedMoves() const { return _playedMoves; }
+
+    void makeMove(const GamePosition & position, const PlayerMarker & playerMarker)
+    {
+        _playedMoves.push_back(_gameBoard.makeMove(position, playerMarker));
+    }
+
+    void undoMove()
+    {
+        if (_playedMoves.empty())
+        {
+            throw runtime_error { "No move left to undo." };
+        }
+
+        _gameBoard.undoMove(_playedMoves.back());
+        _playedMoves.pop_back();
+    }
+
+private:
+
+    GameBoard _gameBoard;
+    vector<PlayedMove> _playedMoves;
+
+};
+
+typedef BasicSearchBoard<StandardGeometry> SearchBoard;
@@ -0,0 +1,97 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <memory>
+
+#include "game_board.h"
+#include "move_history.h"
+#include "search_statistics.h"
+#include "transposition_table.h"
+
+// What the searches of a game keep from one play to the next: the transposition table, the move history,
+// and the principal variation of the last search, whose first plays are the ones most likely to follow.
+// Each search of the game is handed this memory, once it is advanced to the board of that search.
+template <class Geometry>
+class BasicSearchMemory
+{
+public:
+
+    typedef BasicGameBoard<Geometry> GameBoard;
+    typedef BasicBitBoard<Geometry> BitBoard;
+
+    BasicSearchMemory(const size_t transpositionTableSize = DEFAULT_TRANSPOSITION_TABLE_SIZE):
+        _transpositionTable { make_shared<TranspositionTable>(transpositionTableSize) },
+        _moveHistory { make_shared<BasicMoveHistory<Geometry>>(MAX_SEARCH_DEPTH + 1) }
+    {
+    }
+
+    const shared_ptr<TranspositionTable> & transpositionTable() const { return _transpositionTable; }
+
+    const shared_ptr<BasicMoveHistory<Geometry>> & moveHistory() const { return _moveHistory; }
+
+    // Before each search on another board: entries stored so far become older than the ones of the new search,
+    // and the killer moves move up by the plays made since the board of the last search.
+    void advanceTo(const GameBoard & gameBoard)
+    {
+        if (_hasBoard and gameBoard.hashKey() == _boardKey) return;
+
+        if (_hasBoard)
+        {
+            _moveHistory->advance(gameBoard.markCount() - _markCount);
+        }
+
+        _transpositionTable->newSearch();
+
+        _boardKey = gameBoard.hashKey();
+        _markCount = gameBoard.markCount();
+        _hasBoard = true;
+    }
+
+    // Keeps the principal variation found by a search on the given board, for the given player.
+    void remember(const GameBoard & gameBoard, const PlayerMarker & playerMarker, const vector<GamePosition> & principalVariation)
+    {
+        _principalVariation.clear();
+
+        for (const GamePosition & position : principalVariation) _principalVariation.push_back(BitBoard::indexOf(position));
+
+        _variationMarkCount = gameBoard.markCount();
+        _variationPlayer = playerMarker;
+    }
+
+    // The rest of the principal variation remembered, if the plays made since are its first ones;
+    // empty otherwise. Only plays are ever added to a board, so marks matching them all mean the same board.
+    vector<int> principalVariationFor(const GameBoard & gameBoard) const
+    {
+        const int playCount = gameBoard.markCount() - _variationMarkCount;
+
+        if (playCount < 0 or size_t(playCount) >= _principalVariation.size()) return vector<int> {};
+
+        PlayerMarker playerMarker = _variationPlayer;
+
+        for (int i = 0; i < playCount; i++)
+        {
+            if (not gameBoard.markedIn(BitBoard::positionOf(_principalVariation[size_t(i)]), playerMarker)) return vector<int> {};
+
+            playerMarker = opponentOf(playerMarker);
+        }
+
+        return vector<int> { _principalVariation.begin() + playCount, _principalVariation.end() };
+    }
+
+private:
+
+    shared_ptr<TranspositionTable> _transpositionTable;
+    shared_ptr<BasicMoveHistory<Geometry>> _moveHistory;
+
+    HashKey _boardKey = 0;
+    int _markCount = 0;
+    bool _hasBoard = false;
+
+    vector<int> _principalVariation;
+    int _variationMarkCount = 0;
+    PlayerMarker _variationPlayer = X;
+
+};
+
+typedef BasicSearchMemory<StandardGeometry> SearchMemory;
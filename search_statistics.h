@@ -0,0 +1,116 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <ostream>
+
+#include "transposition_table.h"
+
+// Deepest level reached by iterative deepening, however much time is left.
+static constexpr int MAX_SEARCH_DEPTH = 16;
+
+// Cutoffs are counted by the index of the position that caused them, the last index counting all the later ones.
+static constexpr int CUTOFF_INDEX_COUNT = 8;
+
+// What a search did, counted by each search thread on its own, then added up; counting takes no more
+// than an increment per node, so it is always on.
+struct SearchStatistics
+{
+    uint64_t nodeCount = 0;
+    uint64_t plyNodeCounts[MAX_SEARCH_DEPTH + 1] = {}; // Nodes visited on each level; the root is level 0.
+    uint64_t leafCount = 0; // Nodes scored by the heuristic, at the deepest level.
+    uint64_t terminalCount = 0; // Nodes where the game is over.
+    uint64_t expansionCount = 0; // Nodes whose positions were searched.
+    uint64_t childCount = 0; // Positions searched on those nodes.
+    uint64_t cutoffCount = 0;
+    uint64_t cutoffIndexCounts[CUTOFF_INDEX_COUNT] = {};
+    uint64_t aspirationResearchCount = 0;
+    TranspositionStatistics transposition;
+
+    int completedDepth = 0;
+    double seconds = 0;
+    double secondsPerDepth[MAX_SEARCH_DEPTH + 1] = {}; // Time taken by each iteration of the deepening, indexed by its depth, not by ply.
+
+    // Positions searched per node expanded.
+    double branchingFactor() const
+    {
+        return expansionCount == 0 ? 0 : double(childCount) / double(expansionCount);
+    }
+
+    double nodesPerSecond() const
+    {
+        return seconds > 0 ? double(nodeCount) / seconds : 0;
+    }
+
+    // Deepest level visited, even by a search stopped before it completed.
+    int effectiveDepth() const
+    {
+        int depth = 0;
+
+        for (int ply = 0; ply <= MAX_SEARCH_DEPTH; ply++)
+        {
+            if (plyNodeCounts[ply] > 0) depth = ply;
+        }
+
+        return depth;
+    }
+
+    // Counters only: depths and times are kept by the search as a whole.
+    SearchStatistics & operator += (const SearchStatistics & other)
+    {
+        nodeCount += other.nodeCount;
+        leafCount += other.leafCount;
+        terminalCount += other.terminalCount;
+        expansionCount += other.expansionCount;
+        childCount += other.childCount;
+        cutoffCount += other.cutoffCount;
+        aspirationResearchCount += other.aspirationResearchCount;
+        transposition += other.transposition;
+
+        for (int ply = 0; ply <= MAX_SEARCH_DEPTH; ply++) plyNodeCounts[ply] += other.plyNodeCounts[ply];
+        for (int index = 0; index < CUTOFF_INDEX_COUNT; index++) cutoffIndexCounts[index] += other.cutoffIndexCounts[index];
+
+        return *this;
+    }
+
+    void writeJson(ostream & os) const
+    {
+        os << "{\"nodes\":" << nodeCount;
+        os << ",\"nodes_per_ply\":";
+        writeJson(os, plyNodeCounts, effectiveDepth() + 1);
+        os << ",\"leaves\":" << leafCount;
+        os << ",\"terminals\":" << terminalCount;
+        os << ",\"cutoffs\":" << cutoffCount;
+        os << ",\"cutoffs_per_index\":";
+        writeJson(os, cutoffIndexCounts, CUTOFF_INDEX_COUNT);
+        os << ",\"branching_factor\":" << branchingFactor();
+        os << ",\"aspiration_researches\":" << aspirationResearchCount;
+        os << ",\"completed_depth\":" << completedDepth;
+        os << ",\"effective_depth\":" << effectiveDepth();
+        os << ",\"seconds\":" << seconds;
+        os << ",\"seconds_per_depth\":"; // From depth 1 on.
+        writeJson(os, secondsPerDepth + 1, completedDepth);
+        os << ",\"nodes_per_second\":" << nodesPerSecond();
+        os << ",\"transposition\":{\"probes\":" << transposition.probes << ",\"hits\":" << transposition.hits;
+        os << ",\"reuse_hits\":" << transposition.reuseHits;
+        os << ",\"misses\":" << transposition.misses << ",\"collisions\":" << transposition.collisions;
+        os << ",\"stores\":" << transposition.stores << ",\"overwrites\":" << transposition.overwrites << "}";
+        os << "}";
+    }
+
+private:
+
+    template <class Value>
+    static void writeJson(ostream & os, const Value * values, const int count)
+    {
+        os << '[';
+
+        for (int i = 0; i < count; i++)
+        {
+            os << (i > 0 ? "," : "") << values[i];
+        }
+
+        os << ']';
+    }
+
+};
@@ -0,0 +1,290 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#include <fstream>
+#include <random>
+
+#include "player.h"
+
+static const char * const SELF_PLAY_FILE = "gomoku_games.jsonl";
+
+// How one player plays on every game: a fixed depth, unless given a time budget, after its first plays at random.
+// The Monte Carlo engine plays within the time budget, if any, or else the playout budget.
+struct SideSettings
+{
+    bool monteCarlo = false;
+    PlayerSkill skill = Expert;
+    chrono::milliseconds timeBudget { 0 };
+    uint64_t playoutBudget = DEFAULT_PLAYOUT_BUDGET;
+    int randomPlayCount = 0;
+};
+
+struct SelfPlaySettings
+{
+    int gameCount = 100;
+    int threadCount = imax(1, int(thread::hardware_concurrency()));
+    uint32_t seed = 1;
+    string path = SELF_PLAY_FILE;
+    SideSettings sides[2]; // One per player marker.
+};
+
+// Plays engine against engine, many games at a time, one per thread of a thread pool, each engine searching
+// on a single thread. X starts the even games, O the odd ones. Each game finished is written to the file
+// as a line of JSON; nothing is written to the console until all games are done.
+class SelfPlay
+{
+public:
+
+    SelfPlay(const SelfPlaySettings & settings): _settings { settings }, _file { settings.path, ios::trunc }
+    {
+        if (not _file)
+        {
+            throw runtime_error { "Unable to create self-play file: " + settings.path };
+        }
+    }
+
+    void run()
+    {
+        ThreadPool threadPool { _settings.threadCount };
+        atomic<int> runningCount { threadPool.threadCount() };
+
+        for (int worker = 0; worker < threadPool.threadCount(); worker++)
+        {
+            threadPool.submit([this, &runningCount]()
+            {
+                for (int game = _nextGame++; game < _settings.gameCount; game = _nextGame++)
+                {
+                    play(game);
+                }
+
+                runningCount--;
+            });
+        }
+
+        threadPool.helpUntil([&runningCount]() { return runningCount.load() == 0; });
+
+        _file.flush();
+    }
+
+    int winCountOf(const PlayerMarker & marker) const { return _winCounts[marker]; }
+
+    int drawCount() const { return _drawCount; }
+
+private:
+
+    void play(const int game)
+    {
+        const auto start = chrono::steady_clock::now();
+
+        mt19937 random { _settings.seed + uint32_t(game) };
+
+        unique_ptr<Player> players[2] { playerOf(X, game), playerOf(O, game) };
+        int playCounts[2] = { 0, 0 };
+
+        GameBoard gameBoard;
+        vector<GamePosition> positions;
+        PlayerMarker marker = game % 2 == 0 ? X : O;
+
+        while (not gameBoard.isGameOver())
+        {
+            if (playCounts[marker] < _settings.sides[marker].randomPlayCount)
+            {
+                const GamePosition position = randomPositionOn(gameBoard, random);
+
+                gameBoard = gameBoard.play(position, marker);
+            }
+            else
+            {
+                gameBoard = players[marker]->play(gameBoard);
+            }
+
+            positions.push_back(gameBoard.lastPlayedPosition());
+            playCounts[marker]++;
+            marker = opponentOf(marker);
+        }
+
+        const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+
+        write(game, gameBoard, positions, elapsed);
+    }
+
+    unique_ptr<Player> playerOf(const PlayerMarker & marker, const int game) const
+    {
+        const SideSettings & side = _settings.sides[marker];
+
+        unique_ptr<Player> player;
+
+        if (side.monteCarlo)
+        {
+            MonteCarloSettings settings;
+            settings.playoutBudget = side.timeBudget.count() > 0 ? 0 : side.playoutBudget;
+            settings.timeBudget = side.timeBudget;
+            settings.seed = _settings.seed + uint32_t(game);
+
+            player.reset(new MonteCarloPlayer { settings, 1, marker });
+        }
+        else if (side.timeBudget.count() > 0)
+        {
+            player.reset(new AIPlayer { side.timeBudget, 1, marker });
+        }
+        else
+        {
+            player.reset(new AIPlayer { side.skill, 1, marker });
+        }
+
+        player->setQuiet(true);
+
+        return player;
+    }
+
+    // Any candidate position; on the empty board, any position close to the center.
+    static GamePosition randomPositionOn(const GameBoard & gameBoard, mt19937 & random)
+    {
+        const BitBoard slots = gameBoard.markCount() == 0 ?
+            BitBoard::neighborhoodOf(BitBoard::indexOf(CENTER)) :
+            gameBoard.candidateSlots();
+
+        vector<int> indexes;
+
+        slots.forEach([&indexes](const int index) { indexes.push_back(index); });
+
+        uniform_int_distribution<size_t> pick { 0, indexes.size() - 1 };
+
+        return BitBoard::positionOf(indexes[pick(random)]);
+    }
+
+    void write(const int game, const GameBoard & gameBoard, const vector<GamePosition> & positions,
+               const chrono::milliseconds & elapsed)
+    {
+        ostringstream line;
+
+        line << "{\"game\":" << game;
+        line << ",\"first\":\"" << (game % 2 == 0 ? X : O) << '"';
+        line << ",\"winner\":\"" << (gameBoard.hasWinner() ? (gameBoard.winner() == X ? "X" : "O") : "draw") << '"';
+        line << ",\"plays\":" << positions.size();
+        line << ",\"ms\":" << elapsed.count();
+        line << ",\"positions\":[";
+
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            line << (i > 0 ? "," : "") << '"' << char('A' + positions[i].column()) << (positions[i].line() + 1) << '"';
+        }
+
+        line << "]}\n";
+
+        lock_guard<mutex> lock { _fileMutex };
+
+        _file << line.str();
+
+        if (gameBoard.hasWinner())
+        {
+            _winCounts[gameBoard.winner()]++;
+        }
+        else
+        {
+            _drawCount++;
+        }
+    }
+
+    const SelfPlaySettings _settings;
+    atomic<int> _nextGame { 0 };
+
+    mutex _fileMutex;
+    ofstream _file;
+    int _winCounts[2] = { 0, 0 };
+    int _drawCount = 0;
+
+};
+
+static void showUsage()
+{
+    cout << "gomoku_selfplay [--games N] [--threads N] [--seed N] [--output path]" << endl;
+    cout << "                [--x-engine minimax|mcts] [--x-skill 1-4] [--x-time ms] [--x-playouts N] [--x-random plays]" << endl;
+    cout << "                [--o-engine minimax|mcts] [--o-skill 1-4] [--o-time ms] [--o-playouts N] [--o-random plays]" << endl;
+}
+
+// Options of one side start with "--x-" or "--o-".
+static bool parseSide(const string & setting, const string & value, SideSettings & side)
+{
+    if (setting == "engine" and (value == "minimax" or value == "mcts"))
+    {
+        side.monteCarlo = value == "mcts";
+    }
+    else if (setting == "skill")
+    {
+        side.skill = PlayerSkill(imax(int(Novice), imin(int(Master), stoi(value))));
+    }
+    else if (setting == "time")
+    {
+        side.timeBudget = chrono::milliseconds { stoi(value) };
+    }
+    else if (setting == "playouts")
+    {
+        side.playoutBudget = stoull(value);
+    }
+    else if (setting == "random")
+    {
+        side.randomPlayCount = stoi(value);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+static bool parse(const string & option, const string & value, SelfPlaySettings & settings)
+{
+    if (option == "--games")
+    {
+        settings.gameCount = stoi(value);
+    }
+    else if (option == "--threads")
+    {
+        settings.threadCount = stoi(value);
+    }
+    else if (option == "--seed")
+    {
+        settings.seed = uint32_t(stoul(value));
+    }
+    else if (option == "--output")
+    {
+        settings.path = value;
+    }
+    else if (option.compare(0, 4, "--x-") == 0 or option.compare(0, 4, "--o-") == 0)
+    {
+        return parseSide(option.substr(4), value, settings.sides[option[2] == 'x' ? X : O]);
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char * argv[])
+{
+    SelfPlaySettings settings;
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        if (i + 1 >= argc or not parse(argv[i], argv[i + 1], settings))
+        {
+            showUsage();
+            return 1;
+        }
+    }
+
+    const auto start = chrono::steady_clock::now();
+
+    SelfPlay selfPlay { settings };
+    selfPlay.run();
+
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    cout << settings.gameCount << " games in " << elapsed.count() << "s saved to " << settings.path;
+    cout << " (X: " << selfPlay.winCountOf(X) << "; O: " << selfPlay.winCountOf(O) << "; draws: " << selfPlay.drawCount() << ")" << endl;
+
+    return 0;
+}
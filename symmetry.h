@@ -0,0 +1,102 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "bit_board.h"
+
+// The board has eight symmetries: the quarter turns, each with or without a reflection.
+static constexpr int SYMMETRY_COUNT = 8;
+static constexpr int IDENTITY_SYMMETRY = 0;
+
+// BitBoard index each index is taken to by each symmetry, and the symmetry that takes it back.
+template <class Geometry>
+class BasicSymmetries
+{
+public:
+
+    static_assert(Geometry::LINE_COUNT == Geometry::COLUMN_COUNT, "Symmetries take lines to columns, so the board must be square.");
+
+    // The tables of the geometry, computed at compile time.
+    static const BasicSymmetries & shared()
+    {
+        static constexpr BasicSymmetries symmetries {};
+
+        return symmetries;
+    }
+
+    constexpr BasicSymmetries(): _indexes {}, _inverses {}
+    {
+        for (int symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            for (int index = 0; index < Geometry::BIT_COUNT; index++)
+            {
+                _indexes[symmetry][index] = transform(symmetry, index);
+            }
+        }
+
+        for (int symmetry = 0; symmetry < SYMMETRY_COUNT; symmetry++)
+        {
+            for (int inverse = 0; inverse < SYMMETRY_COUNT; inverse++)
+            {
+                if (takesBack(symmetry, inverse))
+                {
+                    _inverses[symmetry] = inverse;
+                }
+            }
+        }
+    }
+
+    // The padding column of BitBoard is taken to itself.
+    constexpr int indexOf(const int symmetry, const int index) const { return _indexes[symmetry][index]; }
+
+    constexpr int inverseOf(const int symmetry) const { return _inverses[symmetry]; }
+
+    GamePosition positionOf(const int symmetry, const GamePosition & position) const
+    {
+        return BasicBitBoard<Geometry>::positionOf(indexOf(symmetry, BasicBitBoard<Geometry>::indexOf(position)));
+    }
+
+private:
+
+    // Bit 2 reflects the columns; bits 0-1 then count the quarter turns.
+    static constexpr int transform(const int symmetry, const int index)
+    {
+        const int last = Geometry::LINE_COUNT - 1;
+
+        int line = index / Geometry::BIT_STRIDE;
+        int column = index % Geometry::BIT_STRIDE;
+
+        if (column == Geometry::COLUMN_COUNT) return index;
+
+        if (symmetry & 4)
+        {
+            column = last - column;
+        }
+
+        for (int turn = 0; turn < (symmetry & 3); turn++)
+        {
+            const int turnedLine = column;
+
+            column = last - line;
+            line = turnedLine;
+        }
+
+        return line * Geometry::BIT_STRIDE + column;
+    }
+
+    constexpr bool takesBack(const int symmetry, const int inverse) const
+    {
+        for (int index = 0; index < Geometry::BIT_COUNT; index++)
+        {
+            if (_indexes[inverse][_indexes[symmetry][index]] != index) return false;
+        }
+
+        return true;
+    }
+
+    int _indexes[SYMMETRY_COUNT][Geometry::BIT_COUNT];
+    int _inverses[SYMMETRY_COUNT];
+
+};
+
+typedef BasicSymmetries<StandardGeometry> Symmetries;
@@ -0,0 +1,198 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "base.h"
+
+// Each thread pushes and pops its own tasks at the back of its queue;
+// a thread out of tasks steals the oldest task from the front of another thread's queue.
+class ThreadPool
+{
+public:
+
+    // The thread count includes the thread that submits the tasks, which works while it waits.
+    ThreadPool(const int threadCount)
+    {
+        const int count = threadCount < 1 ? 1 : threadCount;
+
+        for (int index = 0; index < count; index++)
+        {
+            _queues.push_back(unique_ptr<TaskQueue> { new TaskQueue });
+        }
+
+        for (int index = 1; index < count; index++)
+        {
+            _threads.push_back(thread { [this, index]() { work(index); } });
+        }
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool & operator = (const ThreadPool &) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock { _sleepMutex };
+            _stopping = true;
+        }
+
+        _wakeUp.notify_all();
+
+        for (auto & worker : _threads)
+        {
+            worker.join();
+        }
+    }
+
+    int threadCount() const { return int(_queues.size()); }
+
+    // Index of the queue of the current thread on this pool, from 0 to threadCount() - 1; threads outside the pool,
+    // workers of other pools included, share the first one.
+    int threadIndex() const
+    {
+        const ThreadSlot & slot = threadSlot();
+
+        return slot.pool == this ? slot.index : 0;
+    }
+
+    void submit(function<void()> task)
+    {
+        TaskQueue & queue = *_queues[size_t(threadIndex())];
+
+        {
+            lock_guard<mutex> lock { queue.tasksMutex };
+            queue.tasks.push_back(move(task));
+        }
+
+        {
+            lock_guard<mutex> lock { _sleepMutex };
+            _pendingCount++;
+        }
+
+        _wakeUp.notify_one();
+    }
+
+    // Runs pending tasks, its own first, until done() holds.
+    template <class Predicate>
+    void helpUntil(Predicate done)
+    {
+        while (not done())
+        {
+            if (not runTask(threadIndex()))
+            {
+                this_thread::yield();
+            }
+        }
+    }
+
+private:
+
+    struct TaskQueue
+    {
+        mutex tasksMutex;
+        deque<function<void()>> tasks;
+    };
+
+    // The pool the current thread works for, if any, with the index of its queue there.
+    struct ThreadSlot
+    {
+        const ThreadPool * pool;
+        int index;
+    };
+
+    static ThreadSlot & threadSlot()
+    {
+        static thread_local ThreadSlot slot { nullptr, 0 };
+
+        return slot;
+    }
+
+    void work(const int index)
+    {
+        threadSlot() = ThreadSlot { this, index };
+
+        while (true)
+        {
+            if (not runTask(index))
+            {
+                unique_lock<mutex> lock { _sleepMutex };
+
+                _wakeUp.wait(lock, [this]() { return _stopping or _pendingCount > 0; });
+
+                if (_stopping) return;
+            }
+        }
+    }
+
+    bool runTask(const int index)
+    {
+        function<void()> task;
+
+        if (popOwn(index, task) or steal(index, task))
+        {
+            {
+                lock_guard<mutex> lock { _sleepMutex };
+                _pendingCount--;
+            }
+
+            task();
+
+            return true;
+        }
+
+        return false;
+    }
+
+    bool popOwn(const int index, function<void()> & task)
+    {
+        TaskQueue & queue = *_queues[size_t(index)];
+
+        lock_guard<mutex> lock { queue.tasksMutex };
+
+        if (queue.tasks.empty()) return false;
+
+        task = move(queue.tasks.back());
+        queue.tasks.pop_back();
+
+        return true;
+    }
+
+    bool steal(const int index, function<void()> & task)
+    {
+        const int count = threadCount();
+
+        for (int offset = 1; offset < count; offset++)
+        {
+            TaskQueue & queue = *_queues[size_t((index + offset) % count)];
+
+            lock_guard<mutex> lock { queue.tasksMutex };
+
+            if (not queue.tasks.empty())
+            {
+                task = move(queue.tasks.front());
+                queue.tasks.pop_front();
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    vector<unique_ptr<TaskQueue>> _queues;
+    vector<thread> _threads;
+
+    mutex _sleepMutex;
+    condition_variable _wakeUp;
+    int _pendingCount = 0;
+    bool _stopping = false;
+
+};
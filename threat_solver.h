@@ -0,0 +1,502 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "game_board.h"
+
+// Limits given to each proof, so the solver never holds up the regular search for long.
+static constexpr uint64_t DEFAULT_THREAT_NODE_LIMIT = 200000;
+static constexpr chrono::milliseconds DEFAULT_THREAT_TIME_LIMIT { 200 };
+
+// Deepest victory by continuous threats tried, in moves of the attacker.
+static constexpr int MAX_THREAT_DEPTH = 8;
+
+// The time limit is checked once every THREAT_CHECK_MASK + 1 nodes.
+static constexpr uint64_t THREAT_CHECK_MASK = 0xFF;
+
+// Marks of the player needed around a position, on its lines, to make a four or a three there.
+static constexpr int FOUR_MARK_COUNT = WINNING_COUNT - 2;
+static constexpr int THREE_MARK_COUNT = WINNING_COUNT - 3;
+
+// Shift amounts along the four lines crossing a position.
+static constexpr int LINE_SHIFTS[] = { EAST_SHIFT, SOUTH_SHIFT, SOUTHEAST_SHIFT, SOUTHWEST_SHIFT };
+
+// Threat-space search: proves whether the attacker, to move, wins by forcing moves only.
+//
+// On a victory by continuous fours (VCF), every move of the attacker makes a four, so the defender
+// has a single reply: blocking it. On a victory by continuous threats (VCT), the attacker may also
+// make threes, which are answered by any position on the lines of the threat, or by a four of the defender.
+//
+// Only marks matter to a proof, so the solver plays on its own bit boards, not on a GameBoard.
+// A proof either finds the win or refutes it; a proof stopped by a limit refutes nothing.
+class ThreatSolver
+{
+public:
+
+    ThreatSolver(const GameBoard & gameBoard,
+                 const uint64_t nodeLimit = DEFAULT_THREAT_NODE_LIMIT,
+                 const chrono::milliseconds & timeLimit = DEFAULT_THREAT_TIME_LIMIT):
+        _marks { gameBoard.marksOf(X), gameBoard.marksOf(O) }, _candidates { gameBoard.candidateSlots() },
+        _hashKey { gameBoard.hashKey() }, _nodeLimit { nodeLimit }, _timeLimit { timeLimit }
+    {
+    }
+
+    // On success, the sequence holds the moves of the proof: the attacker's first, the defender's replies in between,
+    // up to the move that wins outright - a five, or a four the defender can not block everywhere.
+    bool victoryByFours(const PlayerMarker & attacker, vector<GamePosition> & sequence)
+    {
+        start();
+
+        return proven(fours(attacker), sequence);
+    }
+
+    // Victories by continuous fours are tried first on every position, since they are cheaper to prove.
+    bool victoryByThreats(const PlayerMarker & attacker, vector<GamePosition> & sequence)
+    {
+        start();
+
+        bool found = false;
+
+        // Iterative deepening, so the shortest proofs are found first, before any limit is reached.
+        for (int depth = 1; depth <= MAX_THREAT_DEPTH and not found and not _limitReached; depth++)
+        {
+            found = threats(attacker, depth);
+        }
+
+        return proven(found, sequence);
+    }
+
+    // Whether the last proof was stopped by the node or time limit.
+    bool limitReached() const { return _limitReached; }
+
+    uint64_t nodeCount() const { return _nodeCount; }
+
+private:
+
+    struct PlayedThreat
+    {
+        int index;
+        PlayerMarker playerMarker;
+        BitBoard previousCandidates;
+    };
+
+    void start()
+    {
+        _deadline = chrono::steady_clock::now() + _timeLimit;
+        _nodeCount = 0;
+        _limitReached = false;
+        _failedFours.clear();
+        _failedThreats.clear();
+        _line.clear();
+        _proof.clear();
+    }
+
+    bool proven(const bool found, vector<GamePosition> & sequence) const
+    {
+        if (found)
+        {
+            sequence.clear();
+
+            for (const int index : _proof) sequence.push_back(BitBoard::positionOf(index));
+        }
+
+        return found;
+    }
+
+    // Counts a node; true once the proof has to stop.
+    bool stopRequested()
+    {
+        if (++_nodeCount >= _nodeLimit or
+            ((_nodeCount & THREAT_CHECK_MASK) == 0 and chrono::steady_clock::now() >= _deadline))
+        {
+            _limitReached = true;
+        }
+
+        return _limitReached;
+    }
+
+    void play(const int index, const PlayerMarker & playerMarker)
+    {
+        _playedMoves.push_back(PlayedThreat { index, playerMarker, _candidates });
+
+        _marks[playerMarker].set(index);
+        _candidates = (_candidates | BitBoard::neighborhoodOf(index)) & ~(_marks[X] | _marks[O]);
+        _hashKey ^= ZobristKeys::shared().keyOf(playerMarker, index);
+        _line.push_back(index);
+    }
+
+    void undo()
+    {
+        const PlayedThreat & played = _playedMoves.back();
+
+        _marks[played.playerMarker].reset(played.index);
+        _candidates = played.previousCandidates;
+        _hashKey ^= ZobristKeys::shared().keyOf(played.playerMarker, played.index);
+        _line.pop_back();
+
+        _playedMoves.pop_back();
+    }
+
+    void proven(const int winningIndex)
+    {
+        _proof = _line;
+        _proof.push_back(winningIndex);
+    }
+
+    bool fours(const PlayerMarker & attacker)
+    {
+        if (stopRequested()) return false;
+
+        const BitBoard wins = winningSlots(attacker);
+
+        if (wins.any())
+        {
+            proven(firstOf(wins));
+            return true;
+        }
+
+        if (_failedFours.count(_hashKey) > 0) return false;
+
+        const HashKey key = _hashKey;
+        const PlayerMarker defender = opponentOf(attacker);
+        const BitBoard defenderWins = winningSlots(defender);
+
+        if (defenderWins.count() > 1) return false;
+
+        // A four of the defender has to be blocked first; the block only goes on if it makes a four as well.
+        const BitBoard moves = defenderWins.any() ? defenderWins : threatSlots(attacker, FOUR_MARK_COUNT);
+
+        bool found = false;
+
+        moves.forEach([this, &attacker, &defender, &found](const int index)
+        {
+            if (found or _limitReached) return;
+
+            play(index, attacker);
+
+            const BitBoard blocks = winningSlotsThrough(index, attacker);
+
+            if (blocks.count() > 1 and not winningSlots(defender).any())
+            {
+                proven(firstOf(blocks));
+                found = true;
+            }
+            else if (blocks.count() == 1)
+            {
+                const int block = firstOf(blocks);
+
+                if (not completes(_marks[defender], block))
+                {
+                    play(block, defender);
+                    found = fours(attacker);
+                    undo();
+                }
+            }
+
+            undo();
+        });
+
+        if (not found and not _limitReached)
+        {
+            _failedFours.insert(key);
+        }
+
+        return found;
+    }
+
+    bool threats(const PlayerMarker & attacker, const int depth)
+    {
+        if (fours(attacker)) return true;
+
+        if (_limitReached or depth == 0) return false;
+
+        const auto failed = _failedThreats.find(_hashKey);
+
+        if (failed != _failedThreats.end() and failed->second >= depth) return false;
+
+        const HashKey key = _hashKey;
+
+        const PlayerMarker defender = opponentOf(attacker);
+        const BitBoard defenderWins = winningSlots(defender);
+
+        if (defenderWins.count() > 1) return false;
+
+        const BitBoard moves = defenderWins.any() ? defenderWins : threatSlots(attacker, THREE_MARK_COUNT);
+
+        bool found = false;
+
+        moves.forEach([this, &attacker, &defender, &found, depth](const int index)
+        {
+            if (found or _limitReached) return;
+
+            play(index, attacker);
+
+            const BitBoard blocks = winningSlotsThrough(index, attacker);
+
+            if (blocks.count() == 1) // A four: blocking it is the only reply.
+            {
+                const int block = firstOf(blocks);
+
+                if (not completes(_marks[defender], block))
+                {
+                    play(block, defender);
+                    found = threats(attacker, depth - 1);
+                    undo();
+                }
+            }
+            else if (not blocks.any()) // Open fours were already tried by fours(); only threes are left.
+            {
+                const BitBoard openFours = openFourSlots(attacker, lineSlotsAround(index));
+
+                if (openFours.any())
+                {
+                    const BitBoard defenses = defenseSlots(index, openFours, defender);
+
+                    if (defenses.any())
+                    {
+                        found = refutesEveryDefense(attacker, defenses, depth);
+                    }
+                    else // A double three, or better: an open four follows whatever the defender plays.
+                    {
+                        proven(firstOf(openFours));
+                        found = true;
+                    }
+                }
+            }
+
+            undo();
+        });
+
+        if (not found and not _limitReached)
+        {
+            _failedThreats[key] = depth;
+        }
+
+        return found;
+    }
+
+    // The attacker, to move after each defense, wins by threats against all of them.
+    bool refutesEveryDefense(const PlayerMarker & attacker, const BitBoard & defenses, const int depth)
+    {
+        const PlayerMarker defender = opponentOf(attacker);
+
+        bool refuted = true;
+        vector<int> proof;
+
+        defenses.forEach([this, &attacker, &defender, &refuted, &proof, depth](const int index)
+        {
+            if (not refuted or _limitReached) return;
+
+            if (completes(_marks[defender], index))
+            {
+                refuted = false;
+                return;
+            }
+
+            play(index, defender);
+
+            refuted = threats(attacker, depth - 1);
+
+            if (refuted and proof.empty()) proof = _proof;
+
+            undo();
+        });
+
+        if (not refuted or _limitReached or proof.empty()) return false;
+
+        _proof = proof; // One line of the proof: the one of the first defense.
+
+        return true;
+    }
+
+    // Replies to a three: the positions on its lines that leave the attacker no open four, and the fours of the defender.
+    // Any other reply loses to an open four.
+    BitBoard defenseSlots(const int index, const BitBoard & openFours, const PlayerMarker & defender)
+    {
+        const PlayerMarker attacker = opponentOf(defender);
+
+        BitBoard lines = lineSlotsAround(index);
+
+        openFours.forEach([&lines](const int openFour)
+        {
+            lines = lines | lineSlotsAround(openFour);
+        });
+
+        BitBoard defenses;
+
+        (lines & ~(_marks[X] | _marks[O])).forEach([this, &defenses, &attacker, &defender, index](const int slot)
+        {
+            _marks[defender].set(slot);
+
+            if (not openFourSlots(attacker, lineSlotsAround(index)).any()) defenses.set(slot);
+
+            _marks[defender].reset(slot);
+        });
+
+        threatSlots(defender, FOUR_MARK_COUNT).forEach([this, &defenses, &defender](const int candidate)
+        {
+            if (winningSlotsThrough(candidate, defender, candidate).any()) defenses.set(candidate);
+        });
+
+        return defenses;
+    }
+
+    // Empty positions, among the given ones, where the player would make a four with two ways to complete it.
+    BitBoard openFourSlots(const PlayerMarker & playerMarker, const BitBoard & slots) const
+    {
+        BitBoard result;
+
+        const BitBoard & marks = _marks[playerMarker];
+
+        (slots & _candidates & ~(_marks[X] | _marks[O])).forEach([this, &result, &playerMarker, &marks](const int index)
+        {
+            if ((lineSlotsAround(index) & marks).count() >= FOUR_MARK_COUNT and
+                winningSlotsThrough(index, playerMarker, index).count() > 1)
+            {
+                result.set(index);
+            }
+        });
+
+        return result;
+    }
+
+    // Candidates with enough marks of the player on their lines, close enough to make a threat with them:
+    // a four takes three other marks; a three, two.
+    BitBoard threatSlots(const PlayerMarker & playerMarker, const int markCount) const
+    {
+        BitBoard result;
+        const BitBoard & marks = _marks[playerMarker];
+
+        _candidates.forEach([&result, &marks, markCount](const int index)
+        {
+            if ((lineSlotsAround(index) & marks).count() >= markCount) result.set(index);
+        });
+
+        return result;
+    }
+
+    // Empty positions where the player would complete a winning sequence.
+    BitBoard winningSlots(const PlayerMarker & playerMarker) const
+    {
+        BitBoard result;
+        const BitBoard & marks = _marks[playerMarker];
+
+        _candidates.forEach([&result, &marks](const int index)
+        {
+            if (completes(marks, index)) result.set(index);
+        });
+
+        return result;
+    }
+
+    // Winning slots on the lines of the given position; as if the player had marked the assumed position too, if any.
+    BitBoard winningSlotsThrough(const int index, const PlayerMarker & playerMarker, const int assumed = -1) const
+    {
+        BitBoard result;
+        BitBoard marks = _marks[playerMarker];
+
+        if (assumed >= 0) marks.set(assumed);
+
+        const BitBoard slots = lineSlotsAround(index) & ~(_marks[X] | _marks[O]);
+
+        slots.forEach([&result, &marks, assumed](const int slot)
+        {
+            if (slot != assumed and completes(marks, slot)) result.set(slot);
+        });
+
+        return result;
+    }
+
+    static bool completes(const BitBoard & marks, const int index)
+    {
+        for (const int shift : LINE_SHIFTS)
+        {
+            if (1 + runLength(marks, index, shift) + runLength(marks, index, -shift) >= WINNING_COUNT)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Marks in a row from the position next to the given one, on the direction of the shift.
+    static int runLength(const BitBoard & marks, const int index, const int shift)
+    {
+        int length = 0;
+
+        for (int current = index + shift; onBoard(current) and marks.test(current); current += shift)
+        {
+            length++;
+        }
+
+        return length;
+    }
+
+    // Positions up to WINNING_COUNT - 1 steps away from the given one, on the four lines crossing it.
+    static const BitBoard & lineSlotsAround(const int index)
+    {
+        static const vector<BitBoard> lineSlots = []()
+        {
+            vector<BitBoard> result { size_t(BIT_COUNT) };
+
+            for (int slot = 0; slot < BIT_COUNT; slot++)
+            {
+                for (const int shift : LINE_SHIFTS)
+                {
+                    for (const int step : { shift, -shift })
+                    {
+                        for (int current = slot + step, count = 1; onBoard(slot) and onBoard(current) and count < WINNING_COUNT;
+                             current += step, count++)
+                        {
+                            result[size_t(slot)].set(current);
+                        }
+                    }
+                }
+            }
+
+            return result;
+        }();
+
+        return lineSlots[size_t(index)];
+    }
+
+    // The padding column stops any walk on a line before it wraps to the next one.
+    static bool onBoard(const int index)
+    {
+        return index >= 0 and index < BIT_COUNT and index % BIT_STRIDE != COLUMN_COUNT;
+    }
+
+    static int firstOf(const BitBoard & slots)
+    {
+        int first = -1;
+
+        slots.forEach([&first](const int index)
+        {
+            if (first < 0) first = index;
+        });
+
+        return first;
+    }
+
+    BitBoard _marks[2];
+    BitBoard _candidates;
+    HashKey _hashKey;
+    vector<PlayedThreat> _playedMoves;
+
+    const uint64_t _nodeLimit;
+    const chrono::milliseconds _timeLimit;
+
+    chrono::steady_clock::time_point _deadline;
+    uint64_t _nodeCount = 0;
+    bool _limitReached = false;
+
+    unordered_set<HashKey> _failedFours; // Positions where the attacker of the current proof has no victory by fours.
+    unordered_map<HashKey, int> _failedThreats; // Same for threats, with the deepest depth refuted.
+    vector<int> _line; // Moves played from the root down to the current position.
+    vector<int> _proof;
+};
@@ -0,0 +1,225 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "score.h"
+#include "zobrist.h"
+
+// How the stored score relates to the actual score of the position.
+enum ScoreBound
+{
+    ExactBound, // Searched inside the (alpha, beta) window.
+    LowerBound, // Failed high: the actual score is at least the stored one.
+    UpperBound  // Failed low: the actual score is at most the stored one.
+};
+
+struct TranspositionEntry
+{
+    Score score;
+    int bestMove; // BitBoard index of the best position found; -1 if none.
+    int depth; // Levels searched below the position.
+    ScoreBound bound;
+};
+
+// Counted by each search thread on its own, then added up, so threads do not contend on counters.
+struct TranspositionStatistics
+{
+    uint64_t probes = 0;
+    uint64_t hits = 0;
+    uint64_t reuseHits = 0; // Hits on entries stored by an earlier search, such as the one of a previous play.
+    uint64_t misses = 0; // Probed slot was empty.
+    uint64_t collisions = 0; // Probed slot held another position.
+    uint64_t stores = 0;
+    uint64_t overwrites = 0; // Stores that replaced another position.
+
+    TranspositionStatistics & operator += (const TranspositionStatistics & other)
+    {
+        probes += other.probes;
+        hits += other.hits;
+        reuseHits += other.reuseHits;
+        misses += other.misses;
+        collisions += other.collisions;
+        stores += other.stores;
+        overwrites += other.overwrites;
+
+        return *this;
+    }
+};
+
+static_assert(sizeof(Score) == sizeof(int32_t), "Scores are packed in 32 bits.");
+
+// Default number of entries; always rounded down to a power of two.
+static constexpr size_t DEFAULT_TRANSPOSITION_TABLE_SIZE = size_t { 1 } << 18;
+
+// Shared by all search threads without locks: each slot keeps the entry packed in one word,
+// next to the key xor'ed with that word, so a slot torn by concurrent stores fails the key check.
+class TranspositionTable
+{
+public:
+
+    TranspositionTable(const size_t size = DEFAULT_TRANSPOSITION_TABLE_SIZE):
+        _slots { new Slot[roundDown(size)] }, _size { roundDown(size) }
+    {
+        for (size_t i = 0; i < _size; i++)
+        {
+            _slots[i].check.store(0, memory_order_relaxed);
+            _slots[i].data.store(0, memory_order_relaxed);
+        }
+    }
+
+    size_t size() const { return _size; }
+
+    // Entries stored before the latest call are kept, but lose priority on replacement.
+    // A search pondering on the table may still be probing and storing while the generation moves on.
+    void newSearch() { _generation.store((generation() + 1) & GENERATION_MASK, memory_order_relaxed); }
+
+    bool probe(const HashKey & key, TranspositionEntry & entry, TranspositionStatistics & statistics) const
+    {
+        statistics.probes++;
+
+        uint64_t data;
+
+        switch (read(key, data))
+        {
+            case Found:
+                statistics.hits++;
+                if (generationOf(data) != generation()) statistics.reuseHits++;
+                entry = unpack(data);
+                return true;
+
+            case Empty:
+                statistics.misses++;
+                return false;
+
+            case Taken:
+                statistics.collisions++;
+                return false;
+        }
+
+        return false;
+    }
+
+    // Same as probe(), but does not count on any statistics.
+    bool lookup(const HashKey & key, TranspositionEntry & entry) const
+    {
+        uint64_t data;
+
+        if (read(key, data) == Found)
+        {
+            entry = unpack(data);
+            return true;
+        }
+
+        return false;
+    }
+
+    // Replacement policy: the same position is always refreshed; another position is only
+    // overwritten if it was stored by an older search, or searched no deeper than the new one.
+    void store(const HashKey & key, const Score & score, const int depth, const ScoreBound & bound, int bestMove,
+               TranspositionStatistics & statistics)
+    {
+        Slot & slot = _slots[key & (_size - 1)];
+
+        uint64_t data;
+        const SlotState state = read(key, data);
+
+        if (state == Taken and generationOf(data) == generation() and depthOf(data) > depth)
+        {
+            return;
+        }
+
+        if (state == Taken)
+        {
+            statistics.overwrites++;
+        }
+        else if (state == Found and bestMove < 0)
+        {
+            bestMove = unpack(data).bestMove; // Keep the best move from the previous search of this position.
+        }
+
+        statistics.stores++;
+
+        data = pack(score, depth, bound, bestMove);
+
+        slot.check.store(key ^ data, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+private:
+
+    struct Slot
+    {
+        atomic<uint64_t> check;
+        atomic<uint64_t> data;
+    };
+
+    enum SlotState { Found, Empty, Taken };
+
+    // Packed entry: score (32 bits), best move + 1 (16 bits), depth + 1 (8 bits), bound (2 bits), generation (6 bits).
+    static constexpr uint64_t GENERATION_MASK = 0x3F;
+
+    uint64_t generation() const { return _generation.load(memory_order_relaxed); }
+
+    SlotState read(const HashKey & key, uint64_t & data) const
+    {
+        const Slot & slot = _slots[key & (_size - 1)];
+
+        data = slot.data.load(memory_order_relaxed);
+
+        const uint64_t check = slot.check.load(memory_order_relaxed);
+
+        if (data == 0)
+        {
+            return Empty;
+        }
+        else if ((check ^ data) != key)
+        {
+            return Taken;
+        }
+        else
+        {
+            return Found;
+        }
+    }
+
+    uint64_t pack(const Score & score, const int depth, const ScoreBound & bound, const int bestMove) const
+    {
+        return uint64_t(uint32_t(score)) |
+               uint64_t(uint16_t(bestMove + 1)) << 32 |
+               uint64_t(uint8_t(depth + 1)) << 48 |
+               uint64_t(bound) << 56 |
+               generation() << 58;
+    }
+
+    static TranspositionEntry unpack(const uint64_t & data)
+    {
+        return TranspositionEntry
+        {
+            Score(uint32_t(data)),
+            int((data >> 32) & 0xFFFF) - 1,
+            depthOf(data),
+            ScoreBound((data >> 56) & 0x3)
+        };
+    }
+
+    static int depthOf(const uint64_t & data) { return int((data >> 48) & 0xFF) - 1; }
+
+    static uint64_t generationOf(const uint64_t & data) { return data >> 58; }
+
+    static size_t roundDown(size_t size)
+    {
+        size_t result = 1;
+
+        while (result * 2 <= size) result *= 2;
+
+        return result;
+    }
+
+    unique_ptr<Slot[]> _slots;
+    size_t _size;
+    atomic<uint64_t> _generation { 0 };
+
+};
@@ -0,0 +1,68 @@
+// Copyright (c) 2015 Quenio Cesar Machado dos Santos. All rights reserved.
+
+#pragma once
+
+#include "bit_board.h"
+#include "player_marker.h"
+
+typedef uint64_t HashKey;
+
+// Random keys for each (player marker, slot) pair; a board's key is the xor of the keys of its marks.
+template <class Geometry>
+class BasicZobristKeys
+{
+public:
+
+    // The keys of the geometry, computed at compile time.
+    static const BasicZobristKeys & shared()
+    {
+        static constexpr BasicZobristKeys keys {};
+
+        return keys;
+    }
+
+    constexpr BasicZobristKeys(): _keys {}, _sideKey { 0 }
+    {
+        uint64_t seed = 0x5EED5EED5EED5EEDULL;
+
+        for (int marker = 0; marker < 2; marker++)
+        {
+            for (int index = 0; index < Geometry::BIT_COUNT; index++)
+            {
+                _keys[marker][index] = next(seed);
+            }
+        }
+
+        _sideKey = next(seed);
+    }
+
+    constexpr HashKey keyOf(const PlayerMarker & playerMarker, const int index) const
+    {
+        return _keys[playerMarker][index];
+    }
+
+    // Distinguishes the same marks with O, instead of X, to play next.
+    constexpr HashKey sideKey() const
+    {
+        return _sideKey;
+    }
+
+private:
+
+    // SplitMix64: fixed seed, so keys are the same on every run.
+    static constexpr uint64_t next(uint64_t & seed)
+    {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+        return z ^ (z >> 31);
+    }
+
+    HashKey _keys[2][Geometry::BIT_COUNT];
+    HashKey _sideKey;
+
+};
+
+typedef BasicZobristKeys<StandardGeometry> ZobristKeys;